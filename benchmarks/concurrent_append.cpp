@@ -0,0 +1,91 @@
+#include "storage_utils/Prelude.h"
+#include <chrono>
+#include <cstdio>
+#include <mutex>
+
+// Measure how emitting particles from 1, 2, 4, ..., 32 threads at once
+// scales, comparing `insert` behind a global mutex with the lock-free
+// `append_concurrently`, appending one particle at a time ("append") or
+// claiming 256 slots at a time ("claim"). Every run emits `NUM_PARTICLES`
+// particles into an empty storage, split evenly across the threads.
+
+typedef std::tuple<float, float, float> Vector3f;
+
+using Particles = VecStorageGroup<float, Vector3f, Vector3f>;
+
+using Clock = std::chrono::steady_clock;
+
+constexpr std::size_t NUM_PARTICLES = 4000000;
+
+constexpr std::size_t CLAIM_SIZE = 256;
+
+Vector3f emit_position(std::size_t thread, std::size_t k) {
+  return Vector3f(thread, k * 0.001, 0.0);
+}
+
+template <typename F>
+double emit_ms(ThreadPool &pool, F emit) {
+  Particles particles;
+  auto start = Clock::now();
+  emit(particles);
+  double ms =
+      std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+  if (particles.size() != NUM_PARTICLES) {
+    printf("expected %lu particles, got %lu\n", NUM_PARTICLES,
+           particles.size());
+  }
+  return ms;
+}
+
+int main() {
+  printf("%8s %12s %12s %12s %10s %10s\n", "threads", "mutex_ms",
+         "append_ms", "claim_ms", "append_x", "claim_x");
+  double base_append_ms = 0.0, base_claim_ms = 0.0;
+  for (std::size_t num_threads : {1, 2, 4, 8, 16, 32}) {
+    ThreadPool pool(num_threads);
+    std::size_t per_thread = NUM_PARTICLES / num_threads;
+
+    double mutex_ms = emit_ms(pool, [&](Particles &particles) {
+      std::mutex mutex;
+      pool.run(num_threads, [&](std::size_t t) {
+        for (std::size_t k = 0; k < per_thread; k++) {
+          std::lock_guard<std::mutex> lock(mutex);
+          particles.insert(1.0, emit_position(t, k), Vector3f(0, 0, 0));
+        }
+      });
+    });
+
+    double append_ms = emit_ms(pool, [&](Particles &particles) {
+      auto appender = particles.append_concurrently(NUM_PARTICLES);
+      pool.run(num_threads, [&](std::size_t t) {
+        for (std::size_t k = 0; k < per_thread; k++) {
+          appender.append(1.0, emit_position(t, k), Vector3f(0, 0, 0));
+        }
+      });
+      appender.commit();
+    });
+
+    double claim_ms = emit_ms(pool, [&](Particles &particles) {
+      auto appender = particles.append_concurrently(NUM_PARTICLES);
+      pool.run(num_threads, [&](std::size_t t) {
+        for (std::size_t k = 0; k < per_thread; k += CLAIM_SIZE) {
+          auto [first, last] =
+              appender.claim(std::min(CLAIM_SIZE, per_thread - k));
+          for (Entity i = first; i < last; i++) {
+            appender.set(i, 1.0, emit_position(t, k + (i - first)),
+                         Vector3f(0, 0, 0));
+          }
+        }
+      });
+      appender.commit();
+    });
+
+    if (num_threads == 1) {
+      base_append_ms = append_ms;
+      base_claim_ms = claim_ms;
+    }
+    printf("%8lu %12.3f %12.3f %12.3f %10.2f %10.2f\n", num_threads, mutex_ms,
+           append_ms, claim_ms, base_append_ms / append_ms,
+           base_claim_ms / claim_ms);
+  }
+}
@@ -0,0 +1,180 @@
+#include "storage_utils/Prelude.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <numeric>
+#include <random>
+#include <utility>
+#include <vector>
+
+// Compare the column layouts of a group of `N` float components: one vector
+// per column (SoA), tiles of 8 and 16 rows (AoSoA), and one vector of rows
+// (AoS), for 2 to 16 components. Every kernel updates the first component:
+// "row_stream" sums all the components of every row in order (through
+// `for_each_chunk`), "row_random" does the same visiting the rows in a
+// random order (through `get_unchecked`), and "column" streams the first
+// component alone. Times are in nanoseconds per row.
+
+using Clock = std::chrono::steady_clock;
+
+constexpr std::size_t NUM_ROWS = 1 << 20;
+
+constexpr int NUM_REPEATS = 10;
+
+template <std::size_t>
+using Float = float;
+
+template <typename Alloc, typename Indices>
+struct Columns;
+
+template <typename Alloc, std::size_t... Is>
+struct Columns<Alloc, std::index_sequence<Is...>> {
+  using Type = BasicVecStorageGroup<LifoReuse, Alloc, Float<Is>...>;
+};
+
+template <typename Alloc, std::size_t N>
+using ColumnGroup =
+    typename Columns<Alloc, std::make_index_sequence<N>>::Type;
+
+template <std::size_t N>
+using RowGroup = VecStorageGroup<std::array<float, N>>;
+
+/**
+ * The row operations of the column groups, component by component
+ */
+struct ColumnRows {
+  template <typename Group, std::size_t N>
+  static void insert(Group &group, float value) {
+    insert_row(group, value, std::make_index_sequence<N>());
+  }
+
+  template <typename Group, std::size_t... Is>
+  static void insert_row(Group &group, float value,
+                         std::index_sequence<Is...>) {
+    group.insert(Float<Is>(value + Is)...);
+  }
+
+  template <typename Group>
+  static void stream_rows(Group &group) {
+    group.for_each_chunk([](Entity begin, Entity end, float *first,
+                            auto *... rest) {
+      for (std::size_t k = 0; k < end - begin; k++) {
+        first[k] += (rest[k] + ... + 0.0f);
+      }
+    });
+  }
+
+  template <typename Group>
+  static void visit_row(Group &group, Entity i) {
+    std::apply(
+        [](float &first, auto &... rest) { first += (rest + ... + 0.0f); },
+        group.get_unchecked(i));
+  }
+
+  template <typename Group>
+  static void stream_column(Group &group) {
+    group.for_each_chunk([](Entity begin, Entity end, float *first, auto...) {
+      for (std::size_t k = 0; k < end - begin; k++) {
+        first[k] += 1.0f;
+      }
+    });
+  }
+};
+
+/**
+ * The row operations of the groups of one array column
+ */
+struct ArrayRows {
+  template <typename Group, std::size_t N>
+  static void insert(Group &group, float value) {
+    std::array<float, N> row;
+    for (std::size_t c = 0; c < N; c++) {
+      row[c] = value + c;
+    }
+    group.insert(row);
+  }
+
+  template <typename Row>
+  static void sum_into_first(Row &row) {
+    float sum = 0.0f;
+    for (std::size_t c = 1; c < row.size(); c++) {
+      sum += row[c];
+    }
+    row[0] += sum;
+  }
+
+  template <typename Group>
+  static void stream_rows(Group &group) {
+    group.for_each_chunk([](Entity begin, Entity end, auto *rows) {
+      for (std::size_t k = 0; k < end - begin; k++) {
+        sum_into_first(rows[k]);
+      }
+    });
+  }
+
+  template <typename Group>
+  static void visit_row(Group &group, Entity i) {
+    sum_into_first(std::get<0>(group.get_unchecked(i)));
+  }
+
+  template <typename Group>
+  static void stream_column(Group &group) {
+    group.for_each_chunk([](Entity begin, Entity end, auto *rows) {
+      for (std::size_t k = 0; k < end - begin; k++) {
+        rows[k][0] += 1.0f;
+      }
+    });
+  }
+};
+
+template <typename F>
+double ns_per_row(F kernel) {
+  auto start = Clock::now();
+  for (int r = 0; r < NUM_REPEATS; r++) {
+    kernel();
+  }
+  std::chrono::duration<double, std::nano> elapsed = Clock::now() - start;
+  return elapsed.count() / (double(NUM_REPEATS) * NUM_ROWS);
+}
+
+template <typename Group, typename Rows, std::size_t N>
+void run(const char *layout, const std::vector<Entity> &order) {
+  Group group;
+  group.reserve(NUM_ROWS);
+  for (std::size_t i = 0; i < NUM_ROWS; i++) {
+    Rows::template insert<Group, N>(group, float(i % 7));
+  }
+
+  double stream = ns_per_row([&] { Rows::stream_rows(group); });
+  double random = ns_per_row([&] {
+    for (Entity i : order) {
+      Rows::visit_row(group, i);
+    }
+  });
+  double column = ns_per_row([&] { Rows::stream_column(group); });
+  std::size_t bytes = group.stats().capacity_bytes();
+  printf("%-12s %4lu %12.3f %12.3f %12.3f %10lu\n", layout, N, stream, random,
+         column, bytes >> 20);
+}
+
+template <std::size_t N>
+void compare(const std::vector<Entity> &order) {
+  run<ColumnGroup<DefaultAlloc, N>, ColumnRows, N>("soa", order);
+  run<ColumnGroup<AoSoA<8>, N>, ColumnRows, N>("aosoa_8", order);
+  run<ColumnGroup<AoSoA<16>, N>, ColumnRows, N>("aosoa_16", order);
+  run<RowGroup<N>, ArrayRows, N>("aos", order);
+}
+
+int main() {
+  std::vector<Entity> order(NUM_ROWS);
+  std::iota(order.begin(), order.end(), 0);
+  std::shuffle(order.begin(), order.end(), std::mt19937(42));
+
+  printf("%-12s %4s %12s %12s %12s %10s\n", "layout", "n", "row_stream",
+         "row_random", "column", "mb");
+  compare<2>(order);
+  compare<4>(order);
+  compare<8>(order);
+  compare<16>(order);
+}
@@ -0,0 +1,54 @@
+#include "storage_utils/Prelude.h"
+#include <chrono>
+#include <cstdio>
+#include <random>
+
+// Measure how the `particles_4` position update scales with `par_for_each`
+// over 1, 2, 4, ..., 32 threads. 30% of the particles are removed before
+// measuring, scattered at random.
+
+typedef std::tuple<float, float> Vector2f;
+
+using Particles = VecStorageGroup<Vector2f, Vector2f>;
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int NUM_PARTICLES = 4000000;
+
+constexpr int NUM_STEPS = 20;
+
+int main() {
+  Particles particles;
+  std::mt19937 engine(42);
+  std::uniform_real_distribution<float> dist(0.0, 1.0);
+  for (int i = 0; i < NUM_PARTICLES; i++) {
+    particles.insert(Vector2f(dist(engine), dist(engine)),
+                     Vector2f(dist(engine) * 0.01, dist(engine) * 0.01));
+  }
+  for (int i = 0; i < NUM_PARTICLES; i++) {
+    if (dist(engine) < 0.3) {
+      particles.remove(i);
+    }
+  }
+
+  printf("%8s %12s %10s\n", "threads", "step_ms", "speedup");
+  double base_ms = 0.0;
+  for (std::size_t num_threads : {1, 2, 4, 8, 16, 32}) {
+    ThreadPool pool(num_threads);
+    auto start = Clock::now();
+    for (int step = 0; step < NUM_STEPS; step++) {
+      particles.par_for_each(pool, [](Entity i, Vector2f &x, Vector2f &v) {
+        std::get<0>(x) += std::get<0>(v);
+        std::get<1>(x) += std::get<1>(v);
+      });
+    }
+    double step_ms =
+        std::chrono::duration<double, std::milli>(Clock::now() - start)
+            .count() /
+        NUM_STEPS;
+    if (num_threads == 1) {
+      base_ms = step_ms;
+    }
+    printf("%8lu %12.3f %10.2f\n", num_threads, step_ms, base_ms / step_ms);
+  }
+}
@@ -0,0 +1,116 @@
+#include "storage_utils/Prelude.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+// Compare the iteration time of the free-slot reuse policies on the
+// `particles_4` workload, scaled up. The "balanced" workload re-inserts
+// exactly as many particles as were removed in each step, the "fluctuating"
+// workload lets the population drain towards half and refill to full,
+// alternating every 50 steps.
+
+typedef std::tuple<float, float> Vector2f;
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int NUM_PARTICLES = 200000;
+
+constexpr int NUM_STEPS = 300;
+
+struct Random {
+  std::mt19937 engine{42};
+  std::uniform_real_distribution<float> dist{0.0, 1.0};
+
+  float operator()() { return this->dist(this->engine); }
+
+  Vector2f point_on_side() {
+    switch (int((*this)() * 4.0)) {
+    case 0:
+      return Vector2f(0.0, (*this)());
+    case 1:
+      return Vector2f((*this)(), 0.0);
+    case 2:
+      return Vector2f(1.0, (*this)());
+    default:
+      return Vector2f((*this)(), 1.0);
+    }
+  }
+
+  Vector2f direction() {
+    float theta = (*this)() * 3.14159265354;
+    float speed = (*this)() * 0.01 + 0.01;
+    return Vector2f(cosf(theta) * speed, sinf(theta) * speed);
+  }
+};
+
+struct Result {
+  double iterate_ms;
+  double step_ms;
+  std::size_t size;
+  std::size_t max_size;
+};
+
+template <typename Reuse>
+Result run(bool fluctuating) {
+  using Particles =
+      BasicVecStorageGroup<Reuse, DefaultAlloc, Vector2f, Vector2f>;
+  Particles particles;
+  Random random;
+  for (int i = 0; i < NUM_PARTICLES; i++) {
+    particles.insert(random.point_on_side(), random.direction());
+  }
+
+  double iterate_ms = 0.0;
+  auto start = Clock::now();
+  for (int step = 0; step < NUM_STEPS; step++) {
+    unsigned int removed_count = 0;
+    for (auto [index, position, _] : particles) {
+      bool out_x = std::get<0>(position) < 0.0 || std::get<0>(position) > 1.0;
+      bool out_y = std::get<1>(position) < 0.0 || std::get<1>(position) > 1.0;
+      if (out_x || out_y) {
+        particles.remove(index);
+        removed_count += 1;
+      }
+    }
+
+    auto iterate_start = Clock::now();
+    for (auto [_, position, velocity] : particles) {
+      std::get<0>(position) += std::get<0>(velocity);
+      std::get<1>(position) += std::get<1>(velocity);
+    }
+    iterate_ms += std::chrono::duration<double, std::milli>(Clock::now() -
+                                                            iterate_start)
+                      .count();
+
+    std::size_t insert_count = removed_count;
+    if (fluctuating) {
+      std::size_t target = (step / 50) % 2 == 0 ? NUM_PARTICLES / 2
+                                                : NUM_PARTICLES;
+      insert_count = target > particles.size() ? target - particles.size() : 0;
+    }
+    for (std::size_t i = 0; i < insert_count; i++) {
+      particles.insert(random.point_on_side(), random.direction());
+    }
+  }
+  double step_ms =
+      std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+  return {iterate_ms / NUM_STEPS, step_ms / NUM_STEPS, particles.size(),
+          particles._max_size()};
+}
+
+void report(const char *policy, const char *workload, Result result) {
+  printf("%-16s %-12s %12.3f %12.3f %10lu %10lu\n", policy, workload,
+         result.iterate_ms, result.step_ms, result.size, result.max_size);
+}
+
+int main() {
+  printf("%-16s %-12s %12s %12s %10s %10s\n", "policy", "workload",
+         "iterate_ms", "step_ms", "size", "max_size");
+  for (bool fluctuating : {false, true}) {
+    const char *workload = fluctuating ? "fluctuating" : "balanced";
+    report("lifo", workload, run<LifoReuse>(fluctuating));
+    report("lowest_first", workload, run<LowestIndexFirstReuse>(fluctuating));
+    report("append_only", workload, run<AppendOnlyReuse>(fluctuating));
+  }
+}
@@ -0,0 +1,152 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#ifndef HARNESS_H
+#define HARNESS_H
+
+/**
+ * Keep `value` from being optimized away, without affecting the code that
+ * computes it
+ */
+template <typename T>
+inline void do_not_optimize(const T &value) {
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : "r,m"(value) : "memory");
+#else
+  static volatile const void *sink;
+  sink = &value;
+#endif
+}
+
+/**
+ * One measurement: `ops` operations of `benchmark` on a storage of `size`
+ * elements with a `churn` fraction of them removed
+ */
+struct BenchResult {
+  std::string benchmark;
+  std::size_t size;
+  double churn;
+  std::size_t ops;
+  double total_ms;
+};
+
+/**
+ * The benchmark harness. Parses the command line, runs the measurements
+ * allowed by the filters and prints them as CSV or JSON.
+ *
+ *   --format csv|json   output format (csv)
+ *   --max-size N        largest storage size to run (1000000)
+ *   --filter NAME       only run the benchmarks whose name contains NAME
+ *   --repetitions N     run every measurement N times and keep the fastest (3)
+ */
+class Harness {
+public:
+  using Clock = std::chrono::steady_clock;
+
+  Harness(int argc, char **argv)
+      : format("csv"), max_size(1000000), repetitions(3) {
+    for (int i = 1; i + 1 < argc; i += 2) {
+      if (std::strcmp(argv[i], "--format") == 0) {
+        this->format = argv[i + 1];
+      } else if (std::strcmp(argv[i], "--max-size") == 0) {
+        this->max_size = std::strtoull(argv[i + 1], nullptr, 10);
+      } else if (std::strcmp(argv[i], "--filter") == 0) {
+        this->filter = argv[i + 1];
+      } else if (std::strcmp(argv[i], "--repetitions") == 0) {
+        this->repetitions = std::max(1, std::atoi(argv[i + 1]));
+      }
+    }
+  }
+
+  /**
+   * Get the storage sizes to run, 1K to 100M by powers of 10 up to
+   * `--max-size`
+   */
+  std::vector<std::size_t> sizes() const {
+    std::vector<std::size_t> sizes;
+    for (std::size_t size = 1000; size <= 100000000; size *= 10) {
+      if (size <= this->max_size) {
+        sizes.push_back(size);
+      }
+    }
+    return sizes;
+  }
+
+  /**
+   * Get the fractions of removed elements to run
+   */
+  std::vector<double> churns() const { return {0.0, 0.1, 0.5, 0.9}; }
+
+  bool enabled(const std::string &benchmark) const {
+    return benchmark.find(this->filter) != std::string::npos;
+  }
+
+  /**
+   * Measure `body`, which performs `ops` operations of `benchmark`. `setup`
+   * prepares a fresh state before each repetition and is not measured.
+   */
+  template <typename Setup, typename Body>
+  void measure(const std::string &benchmark, std::size_t size, double churn,
+               std::size_t ops, Setup setup, Body body) {
+    if (!this->enabled(benchmark)) {
+      return;
+    }
+    double best_ms = 0.0;
+    for (int r = 0; r < this->repetitions; r++) {
+      setup();
+      auto start = Clock::now();
+      body();
+      double ms =
+          std::chrono::duration<double, std::milli>(Clock::now() - start)
+              .count();
+      best_ms = r == 0 ? ms : std::min(best_ms, ms);
+    }
+    this->results.push_back({benchmark, size, churn, ops, best_ms});
+  }
+
+  /**
+   * Same as `measure`, for a `body` that doesn't modify the state
+   */
+  template <typename Body>
+  void measure(const std::string &benchmark, std::size_t size, double churn,
+               std::size_t ops, Body body) {
+    this->measure(benchmark, size, churn, ops, [] {}, body);
+  }
+
+  /**
+   * Print all the results to `stdout`
+   */
+  void report() const {
+    bool json = this->format == "json";
+    printf(json ? "[\n" : "benchmark,size,churn,ops,total_ms,ns_per_op\n");
+    for (std::size_t k = 0; k < this->results.size(); k++) {
+      const BenchResult &r = this->results[k];
+      double ns_per_op = r.ops ? r.total_ms * 1e6 / r.ops : 0.0;
+      if (json) {
+        printf("  {\"benchmark\": \"%s\", \"size\": %zu, \"churn\": %.2f, "
+               "\"ops\": %zu, \"total_ms\": %.4f, \"ns_per_op\": %.3f}%s\n",
+               r.benchmark.c_str(), r.size, r.churn, r.ops, r.total_ms,
+               ns_per_op, k + 1 < this->results.size() ? "," : "");
+      } else {
+        printf("%s,%zu,%.2f,%zu,%.4f,%.3f\n", r.benchmark.c_str(), r.size,
+               r.churn, r.ops, r.total_ms, ns_per_op);
+      }
+    }
+    if (json) {
+      printf("]\n");
+    }
+  }
+
+private:
+  std::string format;
+  std::size_t max_size;
+  std::string filter;
+  int repetitions;
+  std::vector<BenchResult> results;
+};
+
+#endif
@@ -0,0 +1,66 @@
+#include "Harness.h"
+#include "storage_utils/Prelude.h"
+#include <cstdint>
+#include <tuple>
+
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+// The `particles_4` workload in 3D: mass, position and velocity of every
+// particle, with hardening, deformation and charge attached to a subset.
+
+using Vector3f = std::tuple<float, float, float>;
+
+using Particles = VecStorageGroup<float, Vector3f, Vector3f>;
+
+using Hardenings = DenseStorageGroup<float>;
+
+using Deformations = DenseStorageGroup<float, float>;
+
+using Charges = DenseStorageGroup<int>;
+
+/**
+ * A stateless hash of `i` (splitmix64), so that the choice of removed and
+ * attached entities does not need a shuffled array of the size of the
+ * storage
+ */
+inline std::uint64_t hash(std::uint64_t i, std::uint64_t seed = 0) {
+  std::uint64_t z = i + seed * 0x9e3779b97f4a7c15ull + 0x9e3779b97f4a7c15ull;
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+  return z ^ (z >> 31);
+}
+
+/**
+ * Whether entity `i` is picked with probability `fraction` by the stream of
+ * choices `seed`
+ */
+inline bool picked(Entity i, double fraction, std::uint64_t seed) {
+  return hash(i, seed) % 1000 < fraction * 1000;
+}
+
+inline void fill(Particles &particles, std::size_t size) {
+  particles.reserve(size);
+  for (std::size_t i = 0; i < size; i++) {
+    particles.insert(1.0, Vector3f(i, i, i), Vector3f(1, 1, 1));
+  }
+}
+
+/**
+ * Remove the `churn` fraction of the particles, scattered at random
+ */
+inline void churn(Particles &particles, std::size_t size, double churn) {
+  for (Entity i = 0; i < size; i++) {
+    if (picked(i, churn, 0)) {
+      particles.remove(i);
+    }
+  }
+}
+
+// Run the benchmarks of `storage_ops.cpp`
+void run_storage_ops(Harness &harness);
+
+// Run the benchmarks of `joins.cpp`
+void run_joins(Harness &harness);
+
+#endif
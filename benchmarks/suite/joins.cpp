@@ -0,0 +1,50 @@
+#include "Workload.h"
+
+// Benchmarks of the joins of the particles with 1, 2 and 3 dense storages.
+// Half of the particles are hardened, a quarter are deformed and a tenth are
+// charged, so the planner picks a different driver for each join.
+
+void run_joins(Harness &harness) {
+  for (std::size_t size : harness.sizes()) {
+    for (double fraction : harness.churns()) {
+      Particles particles;
+      Hardenings hardenings;
+      Deformations deformations;
+      Charges charges;
+      fill(particles, size);
+      for (Entity i = 0; i < size; i++) {
+        if (picked(i, 0.5, 1)) {
+          hardenings.insert(i, 1.0);
+        }
+        if (picked(i, 0.25, 2)) {
+          deformations.insert(i, 1.0, 0.0);
+        }
+        if (picked(i, 0.1, 3)) {
+          charges.insert(i, 1);
+        }
+      }
+      churn(particles, size, fraction);
+
+      harness.measure("join_1", size, fraction, particles.size(), [&] {
+        for (auto [i, m, x, v, h] : particles.join(hardenings)) {
+          m *= h;
+        }
+        do_not_optimize(particles);
+      });
+      harness.measure("join_2", size, fraction, particles.size(), [&] {
+        for (auto [i, m, x, v, h, tc, ts] :
+             particles.join(hardenings, deformations)) {
+          m *= h * tc;
+        }
+        do_not_optimize(particles);
+      });
+      harness.measure("join_3", size, fraction, particles.size(), [&] {
+        for (auto [i, m, x, v, h, tc, ts, c] :
+             particles.join(hardenings, deformations, charges)) {
+          m *= h * tc * c;
+        }
+        do_not_optimize(particles);
+      });
+    }
+  }
+}
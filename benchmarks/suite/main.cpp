@@ -0,0 +1,14 @@
+#include "Workload.h"
+
+// The benchmark suite of the storage groups. Every measurement is printed as
+// one CSV row (or JSON object) with its operation count and time, so runs of
+// different releases can be compared. See `Harness.h` for the options.
+//
+//   $ ./storage-utils-bench --format json --max-size 100000000 > bench.json
+
+int main(int argc, char **argv) {
+  Harness harness(argc, argv);
+  run_storage_ops(harness);
+  run_joins(harness);
+  harness.report();
+}
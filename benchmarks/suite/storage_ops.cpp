@@ -0,0 +1,108 @@
+#include "Workload.h"
+
+// Benchmarks of the single storage operations: insert, remove, iterate,
+// extract and get_component.
+
+void run_storage_ops(Harness &harness) {
+  for (std::size_t size : harness.sizes()) {
+    // Fill an empty storage
+    Particles particles;
+    harness.measure(
+        "append", size, 0.0, size, [&] { particles = Particles(); },
+        [&] { fill(particles, size); });
+
+    // Fill an empty dense storage in batches of 256, as a per-frame spawn
+    Hardenings hardenings;
+    std::vector<Entity> batch_entities(256);
+    std::vector<float> batch_values(256, 1.0);
+    harness.measure(
+        "dense_insert_many", size, 0.0, size,
+        [&] { hardenings = Hardenings(); },
+        [&] {
+          for (Entity begin = 0; begin < size; begin += 256) {
+            std::size_t count = std::min<std::size_t>(256, size - begin);
+            for (std::size_t k = 0; k < count; k++) {
+              batch_entities[k] = begin + k;
+            }
+            hardenings.insert_many(
+                Span<const Entity>(batch_entities.data(), count),
+                Span<const float>(batch_values.data(), count));
+          }
+          do_not_optimize(hardenings);
+        });
+
+    for (double fraction : harness.churns()) {
+      std::size_t num_removed = 0;
+      for (Entity i = 0; i < size; i++) {
+        num_removed += picked(i, fraction, 0);
+      }
+
+      // Remove the churned particles from a full storage, then refill them
+      if (num_removed > 0) {
+        harness.measure(
+            "remove", size, fraction, num_removed,
+            [&] {
+              particles = Particles();
+              fill(particles, size);
+            },
+            [&] { churn(particles, size, fraction); });
+
+        // Refill the removed slots
+        harness.measure(
+            "insert_reuse", size, fraction, num_removed,
+            [&] {
+              particles = Particles();
+              fill(particles, size);
+              churn(particles, size, fraction);
+            },
+            [&] {
+              for (std::size_t k = 0; k < num_removed; k++) {
+                particles.insert(1.0, Vector3f(k, k, k), Vector3f(1, 1, 1));
+              }
+            });
+      }
+
+      // Read-only operations on the churned storage
+      particles = Particles();
+      fill(particles, size);
+      churn(particles, size, fraction);
+      std::size_t num_valid = particles.size();
+      harness.measure("iterate", size, fraction, num_valid, [&] {
+        for (auto [i, m, x, v] : particles) {
+          std::get<0>(x) += std::get<0>(v);
+          std::get<1>(x) += std::get<1>(v);
+          std::get<2>(x) += std::get<2>(v);
+        }
+        do_not_optimize(particles);
+      });
+      harness.measure("iterate_chunks", size, fraction, num_valid, [&] {
+        particles.for_each_chunk(
+            [](Entity begin, Entity end, float *, Vector3f *x, Vector3f *v) {
+              for (std::size_t k = 0; k < end - begin; k++) {
+                std::get<0>(x[k]) += std::get<0>(v[k]);
+                std::get<1>(x[k]) += std::get<1>(v[k]);
+                std::get<2>(x[k]) += std::get<2>(v[k]);
+              }
+            });
+        do_not_optimize(particles);
+      });
+      harness.measure("extract", size, fraction, num_valid, [&] {
+        auto positions = particles.extract<1>();
+        do_not_optimize(positions.data());
+      });
+      std::vector<Vector3f> buffer(num_valid);
+      harness.measure("extract_into", size, fraction, num_valid, [&] {
+        particles.extract_into<1>(buffer);
+        do_not_optimize(buffer.data());
+      });
+      harness.measure("get_component", size, fraction, size, [&] {
+        float total = 0.0;
+        for (Entity k = 0; k < size; k++) {
+          auto mass = particles.get_component<0>(hash(k) % size);
+          total += mass ? *mass : 0.0f;
+        }
+        do_not_optimize(total);
+      });
+    }
+  }
+}
@@ -0,0 +1,152 @@
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+#ifndef ALLOCATOR_H
+#define ALLOCATOR_H
+
+// The size of a transparent huge page on x86-64 Linux
+constexpr std::size_t HUGE_PAGE_SIZE = std::size_t(2) << 20;
+
+/**
+ * A standard allocator returning memory aligned to `Alignment` bytes (or the
+ * alignment of `T` if that is larger).
+ */
+template <typename T, std::size_t Alignment>
+class AlignedAllocator {
+public:
+  using value_type = T;
+
+  static constexpr std::size_t ALIGNMENT = std::max(Alignment, alignof(T));
+
+  template <typename U>
+  struct rebind {
+    using other = AlignedAllocator<U, Alignment>;
+  };
+
+  AlignedAllocator() {}
+
+  template <typename U>
+  AlignedAllocator(const AlignedAllocator<U, Alignment> &) {}
+
+  T *allocate(std::size_t n) {
+    return static_cast<T *>(
+        ::operator new(n * sizeof(T), std::align_val_t(ALIGNMENT)));
+  }
+
+  void deallocate(T *p, std::size_t n) {
+    ::operator delete(p, n * sizeof(T), std::align_val_t(ALIGNMENT));
+  }
+
+  template <typename U>
+  bool operator==(const AlignedAllocator<U, Alignment> &) const {
+    return true;
+  }
+
+  template <typename U>
+  bool operator!=(const AlignedAllocator<U, Alignment> &) const {
+    return false;
+  }
+};
+
+/**
+ * Same as `AlignedAllocator`, except that allocations of at least `Threshold`
+ * bytes are aligned to a huge page and advised with `MADV_HUGEPAGE`, so that
+ * the kernel backs large columns with huge pages and the TLB covers them.
+ * The advice is skipped on platforms other than Linux.
+ */
+template <typename T, std::size_t Alignment, std::size_t Threshold>
+class HugePageAllocator {
+public:
+  using value_type = T;
+
+  static constexpr std::size_t ALIGNMENT = std::max(Alignment, alignof(T));
+
+  template <typename U>
+  struct rebind {
+    using other = HugePageAllocator<U, Alignment, Threshold>;
+  };
+
+  HugePageAllocator() {}
+
+  template <typename U>
+  HugePageAllocator(const HugePageAllocator<U, Alignment, Threshold> &) {}
+
+  T *allocate(std::size_t n) {
+    std::size_t bytes = n * sizeof(T);
+    if (bytes < Threshold) {
+      return static_cast<T *>(
+          ::operator new(bytes, std::align_val_t(ALIGNMENT)));
+    }
+    void *p = ::operator new(bytes, std::align_val_t(HUGE_PAGE_SIZE));
+#ifdef __linux__
+    madvise(p, bytes, MADV_HUGEPAGE);
+#endif
+    return static_cast<T *>(p);
+  }
+
+  void deallocate(T *p, std::size_t n) {
+    if (n * sizeof(T) < Threshold) {
+      ::operator delete(p, n * sizeof(T), std::align_val_t(ALIGNMENT));
+    } else {
+      ::operator delete(p, n * sizeof(T), std::align_val_t(HUGE_PAGE_SIZE));
+    }
+  }
+
+  template <typename U>
+  bool operator==(const HugePageAllocator<U, Alignment, Threshold> &) const {
+    return true;
+  }
+
+  template <typename U>
+  bool operator!=(const HugePageAllocator<U, Alignment, Threshold> &) const {
+    return false;
+  }
+};
+
+/**
+ * The allocation policies of the storage groups. A policy decides the
+ * allocator of every column through its member alias template
+ *
+ * ``` c++
+ * template <typename T> using Allocator = ...;
+ * ```
+ *
+ * so a custom policy (e.g. routing to a per-frame arena) only has to provide
+ * that alias.
+ */
+
+/**
+ * Allocate the columns with `std::allocator`
+ */
+struct DefaultAlloc {
+  template <typename T>
+  using Allocator = std::allocator<T>;
+};
+
+/**
+ * Allocate the columns aligned to `Alignment` bytes, so that vector loads
+ * over a column never straddle cache lines
+ */
+template <std::size_t Alignment = 64>
+struct AlignedAlloc {
+  template <typename T>
+  using Allocator = AlignedAllocator<T, Alignment>;
+};
+
+/**
+ * Allocate the columns aligned to `Alignment` bytes, and back the columns of
+ * at least `Threshold` bytes with transparent huge pages
+ */
+template <std::size_t Alignment = 64, std::size_t Threshold = HUGE_PAGE_SIZE>
+struct HugePageAlloc {
+  template <typename T>
+  using Allocator = HugePageAllocator<T, Alignment, Threshold>;
+};
+
+#endif
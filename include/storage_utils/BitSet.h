@@ -0,0 +1,219 @@
+#include "Span.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#ifndef BIT_SET_H
+#define BIT_SET_H
+
+/**
+ * Count the trailing zeros of a non-zero 64-bit word
+ */
+inline std::size_t count_trailing_zeros(std::uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_ctzll(word);
+#else
+  std::size_t count = 0;
+  while (!(word & 1)) {
+    word >>= 1;
+    count++;
+  }
+  return count;
+#endif
+}
+
+/**
+ * Count the leading zeros of a non-zero 64-bit word
+ */
+inline std::size_t count_leading_zeros(std::uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_clzll(word);
+#else
+  std::size_t count = 0;
+  while (!(word >> 63)) {
+    word <<= 1;
+    count++;
+  }
+  return count;
+#endif
+}
+
+/**
+ * Count the set bits of a 64-bit word
+ */
+inline std::size_t count_ones(std::uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_popcountll(word);
+#else
+  std::size_t count = 0;
+  for (; word; word &= word - 1) {
+    count++;
+  }
+  return count;
+#endif
+}
+
+/**
+ * A growable bit set packed into 64-bit words. Bits beyond `size()` are
+ * always kept as zero so that the word-level scans never have to mask the
+ * last word.
+ */
+class BitSet {
+public:
+  using Word = std::uint64_t;
+
+  static constexpr std::size_t WORD_BITS = 64;
+
+  BitSet() : num_bits(0) {}
+
+  /**
+   * Get the number of bits (set or not) in this bit set
+   */
+  std::size_t size() const { return this->num_bits; }
+
+  /**
+   * Append a bit to the end of the bit set
+   */
+  void push(bool value) {
+    if (this->num_bits % WORD_BITS == 0) {
+      this->words.push_back(0);
+    }
+    if (value) {
+      this->set(this->num_bits);
+    }
+    this->num_bits++;
+  }
+
+  /**
+   * Grow the bit set to `size` bits, setting all the new bits to `value`, or
+   * shrink it to `size` bits. The new bits are filled a word at a time.
+   */
+  void resize(std::size_t size, bool value) {
+    std::size_t old_size = this->num_bits;
+    this->words.resize((size + WORD_BITS - 1) / WORD_BITS, 0);
+    this->num_bits = size;
+    if (size > old_size && value) {
+      std::size_t begin = old_size, end = size;
+      while (begin < end && begin % WORD_BITS != 0) {
+        this->set(begin++);
+      }
+      for (; begin + WORD_BITS <= end; begin += WORD_BITS) {
+        this->words[begin / WORD_BITS] = ~Word(0);
+      }
+      while (begin < end) {
+        this->set(begin++);
+      }
+    } else if (size < old_size && size % WORD_BITS != 0) {
+      this->words.back() &= ~(~Word(0) << (size % WORD_BITS));
+    }
+  }
+
+  /**
+   * Replace the bits with the first `size` bits packed in `words`
+   */
+  void assign(Span<const Word> words, std::size_t size) {
+    this->words.assign(words.begin(),
+                       words.begin() + (size + WORD_BITS - 1) / WORD_BITS);
+    this->num_bits = size;
+    if (size % WORD_BITS != 0) {
+      this->words.back() &= ~(~Word(0) << (size % WORD_BITS));
+    }
+  }
+
+  /**
+   * Get the memory held by the words, including the reserved ones
+   */
+  std::size_t capacity_bytes() const {
+    return this->words.capacity() * sizeof(Word);
+  }
+
+  void reserve(std::size_t size) {
+    this->words.reserve((size + WORD_BITS - 1) / WORD_BITS);
+  }
+
+  bool test(std::size_t i) const {
+    return (this->words[i / WORD_BITS] >> (i % WORD_BITS)) & 1;
+  }
+
+  void set(std::size_t i) {
+    this->words[i / WORD_BITS] |= Word(1) << (i % WORD_BITS);
+  }
+
+  void reset(std::size_t i) {
+    this->words[i / WORD_BITS] &= ~(Word(1) << (i % WORD_BITS));
+  }
+
+  /**
+   * Reset the bits of the word `word_index` that are set in `mask`
+   */
+  void reset_mask(std::size_t word_index, Word mask) {
+    this->words[word_index] &= ~mask;
+  }
+
+  /**
+   * Find the first set bit at position `i` or after. Dead runs are skipped
+   * one word at a time. Return `size()` if there's no such bit.
+   */
+  std::size_t find_next(std::size_t i) const {
+    if (i >= this->num_bits) {
+      return this->num_bits;
+    }
+    std::size_t word_index = i / WORD_BITS;
+    Word word = this->words[word_index] & (~Word(0) << (i % WORD_BITS));
+    while (word == 0) {
+      if (++word_index == this->words.size()) {
+        return this->num_bits;
+      }
+      word = this->words[word_index];
+    }
+    return word_index * WORD_BITS + count_trailing_zeros(word);
+  }
+
+  /**
+   * Find the first unset bit at position `i` or after. Return `size()` if
+   * there's no such bit.
+   */
+  std::size_t find_next_unset(std::size_t i) const {
+    if (i >= this->num_bits) {
+      return this->num_bits;
+    }
+    std::size_t word_index = i / WORD_BITS;
+    Word word = ~this->words[word_index] & (~Word(0) << (i % WORD_BITS));
+    while (word == 0) {
+      if (++word_index == this->words.size()) {
+        return this->num_bits;
+      }
+      word = ~this->words[word_index];
+    }
+    return std::min(word_index * WORD_BITS + count_trailing_zeros(word),
+                    this->num_bits);
+  }
+
+  /**
+   * Find the last set bit. Return `size()` if there's none.
+   */
+  std::size_t find_last() const {
+    for (std::size_t word_index = this->words.size(); word_index-- > 0;) {
+      if (Word word = this->words[word_index]) {
+        return word_index * WORD_BITS + WORD_BITS - 1 -
+               count_leading_zeros(word);
+      }
+    }
+    return this->num_bits;
+  }
+
+  /**
+   * Get the view of the packed words. Bit `i` is bit `i % 64` of word
+   * `i / 64`.
+   */
+  Span<const Word> words_span() const {
+    return Span<const Word>(this->words.data(), this->words.size());
+  }
+
+private:
+  std::size_t num_bits;
+  std::vector<Word> words;
+};
+
+#endif
@@ -0,0 +1,159 @@
+#include "StorageGroup.h"
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#ifndef COMMAND_BUFFER_H
+#define COMMAND_BUFFER_H
+
+/**
+ * The inserts and removes recorded for one dense storage of a
+ * `CommandBuffer`
+ */
+template <class DS>
+struct DenseCommands {
+  std::vector<std::pair<Entity, typename DS::Bulk>> inserts;
+  std::vector<Entity> removes;
+};
+
+/**
+ * A buffer of inserts and removes on one vec storage group and dense storage
+ * groups, recorded while iterating them and applied in one batched pass
+ * afterwards by `apply`. The storages are left untouched until then, so the
+ * iteration sees a stable set of elements.
+ *
+ * `apply` runs the removes before the inserts: the dense removes, then the
+ * vec removes as one `remove_many` (sorted, liveness cleared a word at a
+ * time, one update of the reuse policy), then the vec inserts, which refill
+ * the freed slots, and last the dense inserts. Owned storages should be
+ * changed through their `OwningGroup` instead.
+ *
+ * Sample usage:
+ *
+ * ``` c++
+ * auto commands = particles.commands(hardenings);
+ * for (auto [i, m, x] : particles) {
+ *   if (out_of_bounds(x)) {
+ *     commands.remove(i);
+ *     commands.remove_from<0>(i);
+ *     commands.insert(m, random_point());
+ *   }
+ * }
+ * commands.apply();
+ * ```
+ */
+template <class VS, class... DSS>
+class CommandBuffer {
+public:
+  CommandBuffer(VS &vs, DSS &... dss) : vs(vs), dss(dss...) {}
+
+  /**
+   * Record an insert into the vec storage, with one argument per component
+   */
+  template <typename... Args>
+  void insert(Args &&... args) {
+    this->inserts.emplace_back(std::forward<Args>(args)...);
+  }
+
+  /**
+   * Record the removal of entity `i` from the vec storage
+   */
+  void remove(Entity i) { this->removes.push_back(i); }
+
+  /**
+   * Record an insert (or overwrite) of entity `i` into the `D`th dense
+   * storage, with one argument per component
+   */
+  template <std::size_t D, typename... Args>
+  void insert_into(Entity i, Args &&... args) {
+    using Bulk = typename std::tuple_element_t<D, std::tuple<DSS...>>::Bulk;
+    std::get<D>(this->dense).inserts.emplace_back(
+        i, Bulk(std::forward<Args>(args)...));
+  }
+
+  /**
+   * Record the removal of entity `i` from the `D`th dense storage
+   */
+  template <std::size_t D>
+  void remove_from(Entity i) {
+    std::get<D>(this->dense).removes.push_back(i);
+  }
+
+  /**
+   * Check if no command is recorded
+   */
+  bool empty() const {
+    bool dense_empty = std::apply(
+        [](const DenseCommands<DSS> &... dense) {
+          return (... && (dense.inserts.empty() && dense.removes.empty()));
+        },
+        this->dense);
+    return this->inserts.empty() && this->removes.empty() && dense_empty;
+  }
+
+  /**
+   * Apply the recorded commands and clear them. Return the entities given
+   * to the vec inserts, in the order they were recorded.
+   */
+  std::vector<Entity> apply() {
+    this->apply_dense_removes(std::index_sequence_for<DSS...>());
+    this->vs.remove_many(std::move(this->removes));
+    std::vector<Entity> entities;
+    entities.reserve(this->inserts.size());
+    for (auto &bulk : this->inserts) {
+      entities.push_back(this->vs.insert_bulk(std::move(bulk)));
+    }
+    this->apply_dense_inserts(std::index_sequence_for<DSS...>());
+    this->clear();
+    return entities;
+  }
+
+  /**
+   * Drop the recorded commands without applying them
+   */
+  void clear() {
+    this->inserts.clear();
+    this->removes.clear();
+    std::apply(
+        [](DenseCommands<DSS> &... dense) {
+          ((dense.inserts.clear(), dense.removes.clear()), ...);
+        },
+        this->dense);
+  }
+
+private:
+  template <std::size_t... Ds>
+  void apply_dense_removes(std::index_sequence<Ds...>) {
+    auto remove_all = [](auto &ds, std::vector<Entity> &removes) {
+      for (Entity i : removes) {
+        ds.remove(i);
+      }
+    };
+    (remove_all(std::get<Ds>(this->dss), std::get<Ds>(this->dense).removes),
+     ...);
+    // The fold is empty without dense storages
+    (void)remove_all;
+  }
+
+  template <std::size_t... Ds>
+  void apply_dense_inserts(std::index_sequence<Ds...>) {
+    auto insert_all = [](auto &ds, auto &inserts) {
+      for (auto &[i, bulk] : inserts) {
+        ds.insert_bulk(i, std::move(bulk));
+      }
+    };
+    (insert_all(std::get<Ds>(this->dss), std::get<Ds>(this->dense).inserts),
+     ...);
+    // The fold is empty without dense storages
+    (void)insert_all;
+  }
+
+  VS &vs;
+  std::tuple<DSS &...> dss;
+
+  std::vector<typename VS::Bulk> inserts;
+  std::vector<Entity> removes;
+  std::tuple<DenseCommands<DSS>...> dense;
+};
+
+#endif
@@ -0,0 +1,118 @@
+#include "StorageGroup.h"
+#include <algorithm>
+#include <atomic>
+#include <optional>
+#include <tuple>
+#include <utility>
+
+#ifndef CONCURRENT_APPENDER_H
+#define CONCURRENT_APPENDER_H
+
+/**
+ * A session appending elements to a vec storage group from several threads
+ * at once, without locks. The storage extends its columns by `capacity`
+ * slots up front (see `VecStorageGroup::append_concurrently`). Every append
+ * then claims slots with one atomic `fetch_add` and writes them in place, so
+ * threads only contend on that counter. The appended elements are invisible
+ * until `commit` makes them valid in one step.
+ *
+ * Appends never refill removed slots, and the storage should not be used in
+ * any other way until the session is committed. `commit` should be called
+ * once all the appending threads are done, e.g. after `ThreadPool::run`
+ * returns. Slots claimed past `capacity` are refused. The session commits
+ * itself when destroyed, if it was not committed before.
+ *
+ * Sample usage:
+ *
+ * ``` c++
+ * auto appender = particles.append_concurrently(num_emitters * 1000);
+ * pool.run(num_emitters, [&](std::size_t emitter) {
+ *   for (int k = 0; k < 1000; k++) {
+ *     appender.append(1.0, emit_position(emitter), emit_velocity(emitter));
+ *   }
+ * });
+ * appender.commit();
+ * ```
+ */
+template <class VS>
+class ConcurrentAppender {
+public:
+  ConcurrentAppender(VS &vs, Entity begin, std::size_t capacity)
+      : vs(vs), begin(begin), capacity(capacity), next(0), committed(false) {}
+
+  ConcurrentAppender(const ConcurrentAppender &) = delete;
+
+  ConcurrentAppender &operator=(const ConcurrentAppender &) = delete;
+
+  ~ConcurrentAppender() { this->commit(); }
+
+  /**
+   * Append an element, with one argument per component. Return its entity,
+   * or `None` if the capacity is used up. Safe to call from any number of
+   * threads at once.
+   */
+  template <typename... Args>
+  std::optional<Entity> append(Args &&... args) {
+    std::size_t k = this->next.fetch_add(1, std::memory_order_relaxed);
+    if (k >= this->capacity) {
+      return {};
+    }
+    this->set(this->begin + k, std::forward<Args>(args)...);
+    return this->begin + k;
+  }
+
+  /**
+   * Claim up to `count` consecutive slots at once, and return them as the
+   * range of entities `[first, last)`, to be written with `set` by the
+   * calling thread. The range is shorter than `count`, possibly empty, once
+   * the capacity runs out. Every claimed slot should be set before `commit`.
+   */
+  std::pair<Entity, Entity> claim(std::size_t count) {
+    std::size_t k = this->next.fetch_add(count, std::memory_order_relaxed);
+    return {this->begin + std::min(k, this->capacity),
+            this->begin + std::min(k + count, this->capacity)};
+  }
+
+  /**
+   * Write the components of the claimed slot `i`, with one argument per
+   * component. The rows of `Tracked` columns were stamped when the storage
+   * was extended, so they are not marked again here.
+   */
+  template <typename... Args>
+  void set(Entity i, Args &&... args) {
+    this->vs.fill_appended(i,
+                           std::forward_as_tuple(std::forward<Args>(args)...));
+  }
+
+  /**
+   * Get the number of slots claimed so far
+   */
+  std::size_t size() const {
+    return std::min(this->next.load(std::memory_order_relaxed),
+                    this->capacity);
+  }
+
+  /**
+   * Make the claimed slots valid elements of the storage, and give back the
+   * rest of the capacity. Return the number of elements appended, which is
+   * zero once the session is committed.
+   */
+  std::size_t commit() {
+    if (this->committed) {
+      return 0;
+    }
+    std::size_t count = this->size();
+    this->vs.commit_appended(count);
+    this->committed = true;
+    return count;
+  }
+
+private:
+  VS &vs;
+  Entity begin;
+  std::size_t capacity;
+  std::atomic<std::size_t> next;
+  bool committed;
+};
+
+#endif
@@ -1,28 +1,34 @@
+#include "Snapshot.h"
+#include "SparseIndex.h"
 #include "StorageGroup.h"
+#include "ThreadPool.h"
 #include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <numeric>
+#include <optional>
 #include <unordered_set>
 
 #ifndef DENSE_STORAGE_GROUP_H
 #define DENSE_STORAGE_GROUP_H
 
-template <typename... Types>
+template <typename Group, typename... Types>
 class DenseStorageGroupIterator {
 public:
   DenseStorageGroupIterator(const std::size_t &storage_size,
                             const std::vector<Entity> &global_index_map,
-                            StorageGroup<Types...> &storage_group,
-                            std::size_t index)
+                            Group &storage_group, std::size_t index)
       : storage_size(storage_size), global_index_map(global_index_map),
         storage_group(storage_group), index(index) {}
 
-  std::tuple<Entity, Types &...> operator*() {
+  std::tuple<Entity, ComponentType<Types> &...> operator*() {
     return std::tuple_cat(std::tie(this->global_index_map[this->index]),
                           this->storage_group.get_bulk(this->index));
   }
 
   void operator++() { this->index++; }
 
-  bool operator!=(DenseStorageGroupIterator<Types...> other) {
+  bool operator!=(DenseStorageGroupIterator<Group, Types...> other) {
     return this->index != other.index;
   }
 
@@ -31,148 +37,302 @@ private:
 
   const std::size_t &storage_size;
   const std::vector<Entity> &global_index_map;
-  StorageGroup<Types...> &storage_group;
+  Group &storage_group;
 };
 
-template <typename... Types>
-class DenseStorageGroup {
+template <class DS, std::size_t... Is>
+class DenseStorageViewIterator {
 public:
-  // The helper type `TypeAt<Index>`
+  DenseStorageViewIterator(DS &ds, std::size_t index) : ds(ds), index(index) {}
+
+  std::tuple<Entity, typename DS::template TypeAt<Is> &...> operator*() {
+    return {this->ds.get_global_index(this->index),
+            this->ds.template get_local_component<Is>(this->index)...};
+  }
+
+  void operator++() { this->index++; }
+
+  bool operator!=(DenseStorageViewIterator<DS, Is...> other) {
+    return this->index != other.index;
+  }
+
+private:
+  DS &ds;
+  std::size_t index;
+};
+
+/**
+ * A sparse set of components: the components are packed densely, and looked
+ * up by entity through `data_index_map`. The `Alloc` policy decides how the
+ * columns are allocated (see `Allocator.h`).
+ */
+template <typename Alloc, typename... Types>
+class BasicDenseStorageGroup {
+public:
+  // The helper type `ColumnAt<Index>` for the declared type of a column
+  template <std::size_t Index>
+  using ColumnAt = typename extract_type_at<Index, Types...>::Type;
+
+  // The helper type `TypeAt<Index>` for the component type of a column
   template <std::size_t Index>
-  using TypeAt = typename extract_type_at<Index, Types...>::Type;
+  using TypeAt = ComponentType<ColumnAt<Index>>;
 
   // The helper type `Bulk` for the tuple of all types
-  using Bulk = std::tuple<Types...>;
+  using Bulk = std::tuple<ComponentType<Types>...>;
 
   // The helper type `BulkRef` for the tuple containing reference to all types
-  using BulkRef = std::tuple<Types &...>;
+  using BulkRef = std::tuple<ComponentType<Types> &...>;
+
+  // The helper type `Group` for the underlying storage group
+  using Group = BasicStorageGroup<Alloc, Types...>;
+
+  // The helper type `StorageAt<Index>` for the column storing `TypeAt<Index>`
+  template <std::size_t Index>
+  using StorageAt = Storage<Index, ColumnAt<Index>, Alloc>;
+
+  // The helper type `Iterator`
+  using Iterator = DenseStorageGroupIterator<Group, Types...>;
 
   /**
    * Default constructor
    */
-  DenseStorageGroup() : storage_size(0) {}
+  BasicDenseStorageGroup() : storage_size(0) {}
 
   std::optional<BulkRef> get(Entity i) {
-    if (i < this->data_index_map.size()) {
-      auto data_index = this->data_index_map[i];
-      if (data_index.has_value()) {
-        return this->storage_group.get_bulk(data_index.value());
-      }
+    auto data_index = this->data_index_map.get(i);
+    if (data_index != SparseIndex::NONE) {
+      return this->storage_group.get_bulk(data_index);
     }
     return {};
   }
 
   BulkRef get_unchecked(Entity i) {
-    auto data_index = this->data_index_map[i];
-    return this->storage_group.get_bulk(data_index.value());
+    auto data_index = this->data_index_map.get_unchecked(i);
+    return this->storage_group.get_bulk(data_index);
   }
 
-  void insert(Entity i, Types... args) {
-    auto data = std::make_tuple(args...);
-    return this->insert_bulk(i, data);
+  void insert(Entity i, ComponentType<Types>... args) {
+    this->emplace_bulk(i, std::forward_as_tuple(std::move(args)...));
   }
 
   void insert_bulk(Entity i, Bulk data) {
-    if (i < this->data_index_map.size()) {
-      auto data_index = this->data_index_map[i];
-      if (data_index.has_value()) {
-        this->storage_group.set_bulk(data_index.value(), data);
-        return;
-      } // Otherwise, append to the storage.
-    } else {
-      this->data_index_map.resize(i + 1, {});
-    }
+    this->emplace_bulk(i, std::move(data));
+  }
+
+  /**
+   * Insert (or overwrite) the element of entity `i` with components
+   * constructed from `args`, one argument per component. The arguments are
+   * forwarded straight into the columns, so an rvalue argument is moved and
+   * never copied.
+   */
+  template <typename... Args>
+  void emplace(Entity i, Args &&... args) {
+    static_assert(sizeof...(Args) == sizeof...(Types),
+                  "There should be one argument per component");
+    this->emplace_bulk(i, std::forward_as_tuple(std::forward<Args>(args)...));
+  }
+
+  /**
+   * Same as `emplace`, with the arguments given as a tuple
+   */
+  template <typename Tuple>
+  void emplace_bulk(Entity i, Tuple &&args) {
+    auto data_index = this->data_index_map.get(i);
+    if (data_index != SparseIndex::NONE) {
+      this->storage_group.set_bulk(data_index, std::forward<Tuple>(args));
+      return;
+    } // Otherwise, append to the storage.
 
     // Append to the storage
     Entity local_index = this->storage_size++;
-    this->data_index_map[i] = local_index;
+    this->data_index_map.set(i, local_index);
     if (local_index < this->global_index_map.size()) {
-      this->storage_group.set_bulk(local_index, data);
+      this->storage_group.set_bulk(local_index, std::forward<Tuple>(args));
       this->global_index_map[local_index] = i;
     } else {
-      this->storage_group.push_bulk(data);
+      this->storage_group.push_bulk(std::forward<Tuple>(args));
       this->global_index_map.push_back(i);
     }
   }
 
-  bool update(Entity i, Types... args) {
-    auto data = std::make_tuple(args...);
-    return this->update_bulk(i, data);
+  /**
+   * Reserve the columns for `n` elements in total
+   */
+  void reserve(std::size_t n) {
+    this->storage_group.reserve(n);
+    this->global_index_map.reserve(n);
   }
 
-  bool update_bulk(Entity i, Bulk data) {
-    if (i < this->data_index_map.size()) {
-      auto data_index = this->data_index_map[i];
-      if (data_index.has_value()) {
-        this->storage_group.set_bulk(data_index.value(), data);
-        return true;
+  /**
+   * Insert (or overwrite) a batch of elements given as one span of entities
+   * and one span per component; all the spans should have the same size.
+   * Runs of new entities are appended to each column as one block.
+   */
+  void insert_many(Span<const Entity> entities,
+                   Span<const ComponentType<Types>>... columns) {
+    auto spans = std::make_tuple(columns...);
+
+    // Grow geometrically, so that many small batches stay amortized linear
+    std::size_t needed = this->storage_size + entities.size();
+    std::size_t capacity = this->global_index_map.capacity();
+    if (needed > capacity) {
+      this->reserve(std::max(needed, 2 * capacity));
+    }
+
+    // The run `[run_begin, k)` of the batch is pending to be appended
+    std::size_t run_begin = 0;
+    for (std::size_t k = 0; k < entities.size(); k++) {
+      Entity i = entities[k];
+      auto data_index = this->data_index_map.get(i);
+      bool is_tail = this->storage_size < this->global_index_map.size();
+      if (data_index == SparseIndex::NONE && !is_tail) {
+        // Extend the pending run
+        this->data_index_map.set(i, this->storage_size++);
+        this->global_index_map.push_back(i);
+        continue;
       }
+
+      // Flush the pending run, then write this element in place
+      this->storage_group.push_many(spans, run_begin, k - run_begin);
+      run_begin = k + 1;
+      if (data_index == SparseIndex::NONE) {
+        data_index = this->storage_size++;
+        this->data_index_map.set(i, data_index);
+        this->global_index_map[data_index] = i;
+      }
+      this->storage_group.set_from(data_index, spans, k);
     }
-    return false;
+    this->storage_group.push_many(spans, run_begin,
+                                  entities.size() - run_begin);
+  }
+
+  bool update(Entity i, ComponentType<Types>... args) {
+    return this->update_from(i, std::forward_as_tuple(std::move(args)...));
+  }
+
+  bool update_bulk(Entity i, Bulk data) {
+    return this->update_from(i, std::move(data));
   }
 
   bool remove(Entity i) {
-    if (i < this->data_index_map.size()) {
-      auto data_index = this->data_index_map[i];
-      if (data_index.has_value()) {
-        Entity last_index = --this->storage_size;
+    auto data_index = this->data_index_map.get(i);
+    if (data_index != SparseIndex::NONE) {
+      Entity last_index = --this->storage_size;
 
-        // Copy the data_index and invalidate the `i`th index
-        this->data_index_map[this->global_index_map[last_index]] =
-            data_index.value();
-        this->data_index_map[i] = {};
+      // Copy the data_index and invalidate the `i`th index
+      this->data_index_map.set(this->global_index_map[last_index], data_index);
+      this->data_index_map.reset(i);
 
-        // Swap the element on data_size & last_index;
-        std::swap(this->global_index_map[data_index.value()],
-                  this->global_index_map[last_index]);
+      // Swap the element on data_size & last_index;
+      std::swap(this->global_index_map[data_index],
+                this->global_index_map[last_index]);
 
-        // Swap the components in the storage
-        this->storage_group.swap(data_index.value(), last_index);
+      // Swap the components in the storage
+      this->storage_group.swap(data_index, last_index);
 
-        // Removal success
-        return true;
-      }
+      // Removal success
+      return true;
     }
     return false;
   }
 
+  /**
+   * Reorder the elements by increasing entity, so that a join walking the
+   * entities in order (e.g. driven by a vec storage) reads the columns of
+   * this storage front to back. Every column and both index maps are
+   * permuted in place.
+   */
+  void sort_by_entity() {
+    auto entities = this->global_index_map.begin();
+    if (std::is_sorted(entities, entities + this->storage_size)) {
+      return;
+    }
+    std::vector<std::uint32_t> order(this->storage_size);
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(),
+              [&](std::uint32_t a, std::uint32_t b) {
+                return entities[a] < entities[b];
+              });
+    this->permute(order);
+  }
+
+  /**
+   * Reorder the elements to match the packed order of `other` (e.g. another
+   * dense storage), so that joining the two walks both in the same order.
+   * The elements whose entities are in `other` come first, in the order of
+   * `other`, followed by the rest in their current order.
+   */
+  template <typename Other>
+  void sort_like(Other &other) {
+    std::vector<std::uint32_t> order;
+    order.reserve(this->storage_size);
+    for (Entity i : other.entities()) {
+      auto data_index = this->data_index_map.get(i);
+      if (data_index != SparseIndex::NONE) {
+        order.push_back(data_index);
+      }
+    }
+    for (std::uint32_t k = 0; k < this->storage_size; k++) {
+      if (!other.contains(this->global_index_map[k])) {
+        order.push_back(k);
+      }
+    }
+    this->permute(order);
+  }
+
+  /**
+   * Follow the entity moves of a compaction of the vec storage this storage
+   * is keyed on (see `VecStorageGroup::compact`). The element of every moved
+   * entity is re-keyed in place, without touching the columns. A stale
+   * element left at the destination of a move (its entity was removed from
+   * the vec storage only) is removed first.
+   */
+  void remap(const EntityRemap &moves) {
+    for (const EntityMove &move : moves) {
+      this->remove(move.to);
+      auto data_index = this->data_index_map.get(move.from);
+      if (data_index != SparseIndex::NONE) {
+        this->data_index_map.reset(move.from);
+        this->data_index_map.set(move.to, data_index);
+        this->global_index_map[data_index] = move.to;
+      }
+    }
+  }
+
   template <std::size_t Index>
   std::optional<TypeAt<Index>> get_component(Entity i) {
-    using S = Storage<Index, TypeAt<Index>>;
-    if (i < this->data_index_map.size()) {
-      auto data_index = this->data_index_map[i];
-      if (data_index.has_value()) {
-        return (static_cast<S &>(this->storage_group)).get(data_index.value());
-      }
+    using S = StorageAt<Index>;
+    auto data_index = this->data_index_map.get(i);
+    if (data_index != SparseIndex::NONE) {
+      return (static_cast<S &>(this->storage_group)).peek(data_index);
     }
     return {};
   }
 
   template <std::size_t Index>
   TypeAt<Index> &get_component_unchecked(Entity i) {
-    using S = Storage<Index, TypeAt<Index>>;
-    auto data_index = this->data_index_map[i];
-    return (static_cast<S &>(this->storage_group)).get(data_index.value());
+    using S = StorageAt<Index>;
+    auto data_index = this->data_index_map.get_unchecked(i);
+    return (static_cast<S &>(this->storage_group)).get(data_index);
   }
 
   template <std::size_t Index>
   bool update_component(Entity i, TypeAt<Index> elem) {
-    using S = Storage<Index, TypeAt<Index>>;
-    if (i < this->data_index_map.size()) {
-      auto data_index = this->data_index_map[i];
-      if (data_index.has_value()) {
-        (static_cast<S &>(this->storage_group)).set(data_index.value(), elem);
-        return true;
-      }
+    using S = StorageAt<Index>;
+    auto data_index = this->data_index_map.get(i);
+    if (data_index != SparseIndex::NONE) {
+      (static_cast<S &>(this->storage_group)).set(data_index, std::move(elem));
+      return true;
     }
     return false;
   }
 
   void print_data_index_map() {
     printf("DataIndexMap: [");
-    for (int i = 0; i < this->data_index_map.size(); i++) {
-      if (this->data_index_map[i].has_value()) {
-        printf("%lu, ", this->data_index_map[i].value());
+    for (Entity i = 0; i < this->data_index_map.extent(); i++) {
+      auto data_index = this->data_index_map.get(i);
+      if (data_index != SparseIndex::NONE) {
+        printf("%u, ", data_index);
       } else {
         printf("None, ");
       }
@@ -180,42 +340,309 @@ public:
     printf("]\n");
   }
 
-  bool contains(Entity i) {
-    if (i < this->data_index_map.size()) {
-      auto data_index = this->data_index_map[i];
-      return data_index.has_value();
+  bool contains(Entity i) { return this->data_index_map.contains(i); }
+
+  /**
+   * Get the entity stored at the packed position `local_index`, which should
+   * be smaller than `size()`
+   */
+  Entity get_global_index(std::size_t local_index) {
+    return this->global_index_map[local_index];
+  }
+
+  /**
+   * Get the packed position of entity `i`, or `SparseIndex::NONE` if it's not
+   * in this storage
+   */
+  SparseIndex::LocalIndex get_local_index(Entity i) {
+    return this->data_index_map.get(i);
+  }
+
+  /**
+   * Get the components at the packed position `local_index`, which should be
+   * smaller than `size()`
+   */
+  BulkRef get_local(std::size_t local_index) {
+    return this->storage_group.get_bulk(local_index);
+  }
+
+  /**
+   * Get the component `Index` at the packed position `local_index`, which
+   * should be smaller than `size()`
+   */
+  template <std::size_t Index>
+  TypeAt<Index> &get_local_component(std::size_t local_index) {
+    using S = StorageAt<Index>;
+    return (static_cast<S &>(this->storage_group)).get(local_index);
+  }
+
+  /**
+   * Swap the elements at the packed positions `a` and `b`, keeping their
+   * entities attached to them
+   */
+  void swap_local(std::size_t a, std::size_t b) {
+    if (a != b) {
+      Entity i = this->global_index_map[a], j = this->global_index_map[b];
+      this->storage_group.swap(a, b);
+      std::swap(this->global_index_map[a], this->global_index_map[b]);
+      this->data_index_map.set(i, b);
+      this->data_index_map.set(j, a);
     }
-    return false;
+  }
+
+  /**
+   * Get the contiguous view of the component column `Index`. The column is
+   * packed, so all the `size()` elements are valid and need no mask; the
+   * entity of each element is given by `entities()` at the same position.
+   * A `Paged` column is viewed as a `PagedSpan` instead.
+   */
+  template <std::size_t Index>
+  auto column() {
+    using S = StorageAt<Index>;
+    return (static_cast<S &>(this->storage_group))
+        .span()
+        .first(this->storage_size);
+  }
+
+  /**
+   * Get the packed view of the entities contained in this storage
+   */
+  Span<const Entity> entities() {
+    return Span<const Entity>(this->global_index_map.data(),
+                              this->storage_size);
+  }
+
+  /**
+   * Start a new version of the `Tracked` column `Index`, and return the one
+   * that was current; see `for_each_changed`
+   */
+  template <std::size_t Index>
+  std::uint64_t advance_version() {
+    using S = StorageAt<Index>;
+    return static_cast<S &>(this->storage_group).advance_version();
+  }
+
+  /**
+   * Call `fn(entity, component)` on every element whose `Tracked` column
+   * `Index` was written after version `since`, in storage order. Removing an
+   * element moves the last one into its place, which counts as a write of
+   * the moved element. Reading the component in `fn` does not count as a
+   * write.
+   */
+  template <std::size_t Index, typename F>
+  void for_each_changed(std::uint64_t since, F fn) {
+    using S = StorageAt<Index>;
+    S &storage = static_cast<S &>(this->storage_group);
+    for (std::size_t k = storage.find_changed(0, since);
+         k < this->storage_size; k = storage.find_changed(k + 1, since)) {
+      fn(this->global_index_map[k], storage.peek(k));
+    }
+  }
+
+  /**
+   * Get the memory footprint of this storage: the bytes used and reserved by
+   * every column, and the bytes of the sparse index and the entity map. The
+   * elements are always packed, so there are no removed slots.
+   */
+  StorageStats stats() {
+    StorageStats stats;
+    stats.size = this->storage_size;
+    stats.slots = this->storage_size;
+    this->storage_group.column_stats(stats.columns, this->storage_size);
+    stats.index_bytes = this->data_index_map.capacity_bytes() +
+                        this->global_index_map.capacity() * sizeof(Entity);
+    return stats;
+  }
+
+  /**
+   * Write the binary snapshot of this storage to `out`, in the format of
+   * `Snapshot.h`: the entity of every element and every column as raw bytes.
+   * All the component types should be bitwise copyable (see
+   * `is_bitwise_copyable`). Return `false` if the stream failed.
+   */
+  bool save(std::ostream &out) {
+    SnapshotWriter writer(out);
+    write_snapshot_header<Types...>(writer, SnapshotKind::Dense,
+                                    this->storage_size, this->storage_size);
+    writer.write_column(this->entities());
+    this->save_columns(writer, std::index_sequence_for<Types...>());
+    return writer.good();
+  }
+
+  /**
+   * Load a snapshot written by `save` into this storage, which should be
+   * empty. Return `false` if this storage is not empty, `snapshot` is not
+   * of a dense storage, or it holds an entity twice.
+   */
+  bool restore(const SnapshotView<Types...> &snapshot) {
+    if (snapshot.snapshot_kind() != SnapshotKind::Dense ||
+        !this->global_index_map.empty()) {
+      return false;
+    }
+    Span<const Entity> entities = snapshot.entities();
+    for (std::size_t k = 0; k < entities.size(); k++) {
+      if (this->data_index_map.contains(entities[k])) {
+        this->data_index_map = SparseIndex();
+        return false;
+      }
+      this->data_index_map.set(entities[k], k);
+    }
+    this->storage_group.push_many(snapshot.all_columns(), 0, entities.size());
+    this->global_index_map.assign(entities.begin(), entities.end());
+    this->storage_size = entities.size();
+    return true;
   }
 
   std::size_t size() { return this->storage_size; }
 
   bool is_empty() { return this->size() == 0; }
 
-  DenseStorageGroupIterator<Types...> begin() {
-    return DenseStorageGroupIterator(this->storage_size, this->global_index_map,
-                                     this->storage_group, 0);
+  /**
+   * Call `fn(entity, components...)` on every element in parallel, in chunks
+   * of `PAR_CHUNK_SIZE` packed elements run on `pool`. `fn` may modify the
+   * components it is given, but must not insert or remove.
+   */
+  template <typename F>
+  void par_for_each(ThreadPool &pool, F fn) {
+    this->storage_group.advise_sequential();
+    std::size_t size = this->storage_size;
+    std::size_t num_chunks = (size + PAR_CHUNK_SIZE - 1) / PAR_CHUNK_SIZE;
+    pool.run(num_chunks, [&](std::size_t chunk) {
+      std::size_t end = std::min(size, (chunk + 1) * PAR_CHUNK_SIZE);
+      for (std::size_t i = chunk * PAR_CHUNK_SIZE; i < end; i++) {
+        std::apply(fn,
+                   std::tuple_cat(std::make_tuple(this->global_index_map[i]),
+                                  this->storage_group.get_bulk(i)));
+      }
+    });
   }
 
-  DenseStorageGroupIterator<Types...> end() {
-    return DenseStorageGroupIterator(this->storage_size, this->global_index_map,
-                                     this->storage_group, this->storage_size);
+  /**
+   * Same as `par_for_each(pool, fn)`, running on the global thread pool
+   */
+  template <typename F>
+  void par_for_each(F fn) {
+    this->par_for_each(ThreadPool::global(), fn);
+  }
+
+  /**
+   * Call `fn(begin, end, columns...)` on every run `[begin, end)` of packed
+   * positions, where `columns` are raw pointers to the element at position
+   * `begin` of every column; the entities are `entities()` at the same
+   * positions (see `VecStorageGroup::for_each_chunk`). The whole storage is
+   * a single chunk unless a `Paged` column splits it at its pages.
+   */
+  template <typename F>
+  void for_each_chunk(F fn) {
+    for (std::size_t begin = 0; begin < this->storage_size;) {
+      std::size_t end = std::min(this->storage_size,
+                                 this->storage_group.contiguous_end(begin));
+      std::apply([&](auto *... columns) { fn(begin, end, columns...); },
+                 this->storage_group.data_at(begin, end - begin));
+      begin = end;
+    }
+  }
+
+  /**
+   * Get the end of the block of packed positions from `local_index` on that
+   * is contiguous in every column
+   */
+  std::size_t contiguous_end(std::size_t local_index) {
+    return this->storage_group.contiguous_end(local_index);
+  }
+
+  /**
+   * Get the pointers to the `count` elements from the packed position
+   * `local_index` on in every column, which should lie in one contiguous
+   * block (see `contiguous_end`)
+   */
+  auto data_at(std::size_t local_index, std::size_t count) {
+    return this->storage_group.data_at(local_index, count);
+  }
+
+  /**
+   * Get a view iterating the elements as `(entity, components...)` with only
+   * the component columns `Is...` (see `VecStorageGroup::view`)
+   */
+  template <std::size_t... Is>
+  View<DenseStorageViewIterator<BasicDenseStorageGroup<Alloc, Types...>,
+                                Is...>>
+  view() {
+    using ViewIterator =
+        DenseStorageViewIterator<BasicDenseStorageGroup<Alloc, Types...>,
+                                 Is...>;
+    (static_cast<StorageAt<Is> &>(this->storage_group).advise_sequential(),
+     ...);
+    return View<ViewIterator>(ViewIterator(*this, 0),
+                              ViewIterator(*this, this->storage_size));
+  }
+
+  Iterator begin() {
+    this->storage_group.advise_sequential();
+    return Iterator(this->storage_size, this->global_index_map,
+                    this->storage_group, 0);
+  }
+
+  Iterator end() {
+    return Iterator(this->storage_size, this->global_index_map,
+                    this->storage_group, this->storage_size);
   }
 
 private:
   std::size_t storage_size;
 
-  // From global index to local index. The local index is optional since the
-  // data might not be contained in this storage. This map should have the same
-  // size as the maximal `Entity` appeared in this storage group.
-  std::vector<std::optional<Entity>> data_index_map;
+  // From global index to local index. The local index is `SparseIndex::NONE`
+  // when the data is not contained in this storage. Only the pages covering
+  // the entities appeared in this storage group are allocated. Local indices
+  // are 32-bit, so a dense storage holds at most 2^32 - 1 elements.
+  SparseIndex data_index_map;
 
   // From local index to global index. Has the size the same as `storage_size`
   // and `storage_group`.
   std::vector<Entity> global_index_map;
 
   // The dense storage group.
-  StorageGroup<Types...> storage_group;
+  Group storage_group;
+
+  /**
+   * Move the element at `order[k]` to position `k`, for every `k`, by
+   * swapping along the cycles of the permutation. `order` is reset to the
+   * identity along the way.
+   */
+  void permute(std::vector<std::uint32_t> &order) {
+    for (std::uint32_t k = 0; k < order.size(); k++) {
+      std::uint32_t j = k;
+      while (order[j] != k) {
+        std::uint32_t next = order[j];
+        this->storage_group.swap(j, next);
+        std::swap(this->global_index_map[j], this->global_index_map[next]);
+        order[j] = j;
+        j = next;
+      }
+      order[j] = j;
+    }
+    for (std::uint32_t k = 0; k < this->storage_size; k++) {
+      this->data_index_map.set(this->global_index_map[k], k);
+    }
+  }
+
+  template <std::size_t... Indices>
+  void save_columns(SnapshotWriter &writer, std::index_sequence<Indices...>) {
+    (writer.write_column(this->template column<Indices>()), ...);
+  }
+
+  template <typename Tuple>
+  bool update_from(Entity i, Tuple &&args) {
+    auto data_index = this->data_index_map.get(i);
+    if (data_index != SparseIndex::NONE) {
+      this->storage_group.set_bulk(data_index, std::forward<Tuple>(args));
+      return true;
+    }
+    return false;
+  }
 };
 
+template <typename... Types>
+using DenseStorageGroup = BasicDenseStorageGroup<DefaultAlloc, Types...>;
+
 #endif
\ No newline at end of file
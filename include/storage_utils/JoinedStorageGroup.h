@@ -1,3 +1,11 @@
+#include "StorageGroup.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <tuple>
+#include <vector>
+
 #ifndef JOINED_STORAGE_GROUP_H
 #define JOINED_STORAGE_GROUP_H
 
@@ -13,7 +21,33 @@ class JoinedStorageGroupBase {
 public:
   bool contains(Entity i) { return true; }
 
+  bool contains_except(std::size_t driver, Entity i) { return true; }
+
   std::tuple<> get_unchecked(Entity i) { return std::make_tuple(); }
+
+  void find_smallest(std::size_t &driver, std::size_t &driver_size) {}
+
+  std::size_t size_of(std::size_t driver) { return 0; }
+
+  Entity global_index_of(std::size_t driver, std::size_t local_index) {
+    return 0;
+  }
+
+  void stats(std::vector<StorageStats> &stats) {}
+
+  void local_indices(Entity i, std::size_t *locals) {}
+
+  bool continues(Entity i, std::size_t offset, const std::size_t *locals) {
+    return true;
+  }
+
+  std::size_t contiguous_length(const std::size_t *locals) {
+    return std::numeric_limits<std::size_t>::max();
+  }
+
+  std::tuple<> data_at(const std::size_t *locals, std::size_t count) {
+    return std::make_tuple();
+  }
 };
 
 template <std::size_t Index, typename DS, typename... DenseStorages>
@@ -30,19 +64,134 @@ public:
            JoinedStorageGroupBase<Index + 1, DenseStorages...>::contains(i);
   }
 
+  /**
+   * Same as `contains`, but skip the probe into the `driver`th storage
+   */
+  bool contains_except(std::size_t driver, Entity i) {
+    return (driver == Index || JoinedStorage<Index, DS>::storage.contains(i)) &&
+           JoinedStorageGroupBase<Index + 1, DenseStorages...>::contains_except(
+               driver, i);
+  }
+
   auto get_unchecked(Entity i) {
     return std::tuple_cat(
         JoinedStorage<Index, DS>::storage.get_unchecked(i),
         JoinedStorageGroupBase<Index + 1, DenseStorages...>::get_unchecked(i));
   }
+
+  /**
+   * Get the component `Column` of entity `i`, counting the columns of all
+   * the dense storages from this one on
+   */
+  template <std::size_t Column>
+  decltype(auto) get_component_unchecked(Entity i) {
+    constexpr std::size_t num_columns =
+        std::tuple_size<typename DS::Bulk>::value;
+    if constexpr (Column < num_columns) {
+      return JoinedStorage<Index, DS>::storage
+          .template get_component_unchecked<Column>(i);
+    } else {
+      return JoinedStorageGroupBase<Index + 1, DenseStorages...>::
+          template get_component_unchecked<Column - num_columns>(i);
+    }
+  }
+
+  /**
+   * Update `driver` and `driver_size` if one of the storages is smaller
+   */
+  void find_smallest(std::size_t &driver, std::size_t &driver_size) {
+    std::size_t size = JoinedStorage<Index, DS>::storage.size();
+    if (size < driver_size) {
+      driver = Index;
+      driver_size = size;
+    }
+    JoinedStorageGroupBase<Index + 1, DenseStorages...>::find_smallest(
+        driver, driver_size);
+  }
+
+  std::size_t size_of(std::size_t driver) {
+    if (driver == Index) {
+      return JoinedStorage<Index, DS>::storage.size();
+    }
+    return JoinedStorageGroupBase<Index + 1, DenseStorages...>::size_of(driver);
+  }
+
+  Entity global_index_of(std::size_t driver, std::size_t local_index) {
+    if (driver == Index) {
+      return JoinedStorage<Index, DS>::storage.get_global_index(local_index);
+    }
+    return JoinedStorageGroupBase<Index + 1, DenseStorages...>::global_index_of(
+        driver, local_index);
+  }
+
+  void stats(std::vector<StorageStats> &stats) {
+    stats.push_back(JoinedStorage<Index, DS>::storage.stats());
+    JoinedStorageGroupBase<Index + 1, DenseStorages...>::stats(stats);
+  }
+
+  /**
+   * Store the packed position of entity `i` in every storage to `locals`
+   */
+  void local_indices(Entity i, std::size_t *locals) {
+    locals[Index] = JoinedStorage<Index, DS>::storage.get_local_index(i);
+    JoinedStorageGroupBase<Index + 1, DenseStorages...>::local_indices(
+        i, locals);
+  }
+
+  /**
+   * Check if entity `i` sits `offset` positions after `locals` in every
+   * storage
+   */
+  bool continues(Entity i, std::size_t offset, const std::size_t *locals) {
+    return JoinedStorage<Index, DS>::storage.get_local_index(i) ==
+               locals[Index] + offset &&
+           JoinedStorageGroupBase<Index + 1, DenseStorages...>::continues(
+               i, offset, locals);
+  }
+
+  /**
+   * Get the number of positions from `locals` on that are contiguous in
+   * every column of every storage
+   */
+  std::size_t contiguous_length(const std::size_t *locals) {
+    std::size_t local = locals[Index];
+    return std::min(
+        JoinedStorage<Index, DS>::storage.contiguous_end(local) - local,
+        JoinedStorageGroupBase<Index + 1, DenseStorages...>::contiguous_length(
+            locals));
+  }
+
+  auto data_at(const std::size_t *locals, std::size_t count) {
+    return std::tuple_cat(
+        JoinedStorage<Index, DS>::storage.data_at(locals[Index], count),
+        JoinedStorageGroupBase<Index + 1, DenseStorages...>::data_at(locals,
+                                                                     count));
+  }
 };
 
 template <class VS, class... DSS>
 class JoinedStorageGroupIterator;
 
+template <class JS, std::size_t... Is>
+class JoinedStorageViewIterator;
+
+/**
+ * A join of one vec storage group with any number of dense storage groups.
+ * Iteration is driven by the smallest participating storage: either the
+ * valid indices of the vec storage, or the packed entities of one of the
+ * dense storages. The entities of the driver are then probed in all the
+ * other storages, so the cost scales with the smallest storage.
+ */
 template <class VS, class... DSS>
 class JoinedStorageGroup {
 public:
+  // The driver number denoting the vec storage. Dense storages are numbered
+  // from `0` in the order they are joined.
+  static constexpr std::size_t VEC_DRIVER = sizeof...(DSS);
+
+  // The position of the end iterator
+  static constexpr std::size_t END = std::numeric_limits<std::size_t>::max();
+
   JoinedStorageGroup(VS &vs, DSS &... dss) : vs(vs), dss(dss...) {}
 
   bool contains(Entity i) {
@@ -50,12 +199,180 @@ public:
   }
 
   auto get_unchecked(Entity i) {
-    return std::tuple_cat(std::tie(i), this->vs.get_unchecked(i),
+    return std::tuple_cat(std::make_tuple(i), this->vs.get_unchecked(i),
                           this->dss.get_unchecked(i));
   }
 
   std::size_t size() { return this->vs.size(); }
 
+  /**
+   * Get the component `Index` of entity `i`, counting the components in the
+   * order they are yielded: the vec components, then the dense components
+   * in the order the storages are joined
+   */
+  template <std::size_t Index>
+  decltype(auto) get_component_unchecked(Entity i) {
+    constexpr std::size_t num_columns =
+        std::tuple_size<typename VS::Bulk>::value;
+    if constexpr (Index < num_columns) {
+      return this->vs.template get_component_unchecked<Index>(i);
+    } else {
+      return this->dss.template get_component_unchecked<Index - num_columns>(
+          i);
+    }
+  }
+
+  /**
+   * Pick the storage to drive the iteration, which is the smallest one
+   */
+  std::size_t plan() {
+    std::size_t driver = VEC_DRIVER, driver_size = this->vs.size();
+    this->dss.find_smallest(driver, driver_size);
+    return driver;
+  }
+
+  /**
+   * Get the number of positions to walk in the `driver` storage
+   */
+  std::size_t extent_of(std::size_t driver) {
+    if (driver == VEC_DRIVER) {
+      return this->vs._max_size();
+    }
+    return this->dss.size_of(driver);
+  }
+
+  /**
+   * Find the first position in `[position, limit)` of the `driver` storage
+   * whose entity is contained in every joined storage. Return `END` if there
+   * is none.
+   */
+  std::size_t seek(std::size_t driver, std::size_t position,
+                   std::size_t limit = END) {
+    limit = std::min(limit, this->extent_of(driver));
+    if (driver == VEC_DRIVER) {
+      for (position = this->vs.find_next(position); position < limit;
+           position = this->vs.find_next(position + 1)) {
+        if (this->dss.contains(position)) {
+          return position;
+        }
+      }
+    } else {
+      for (; position < limit; position++) {
+        Entity i = this->dss.global_index_of(driver, position);
+        if (this->vs.contains(i) && this->dss.contains_except(driver, i)) {
+          return position;
+        }
+      }
+    }
+    return END;
+  }
+
+  /**
+   * Get the entity at `position` of the `driver` storage
+   */
+  Entity global_index_of(std::size_t driver, std::size_t position) {
+    if (driver == VEC_DRIVER) {
+      return position;
+    }
+    return this->dss.global_index_of(driver, position);
+  }
+
+  /**
+   * Call `fn(begin, end, columns...)` on every run `[begin, end)` of joined
+   * entities that are contiguous in every column: consecutive entities whose
+   * packed positions are consecutive in every dense storage as well, e.g.
+   * after `sort_by_entity`. `columns` are raw pointers to the element of
+   * entity `begin` in every column, the vec columns first (see
+   * `VecStorageGroup::for_each_chunk`). Unsorted dense storages give runs of
+   * a single entity.
+   */
+  template <typename F>
+  void for_each_chunk(F fn) {
+    std::size_t driver = this->plan();
+    std::size_t extent = this->extent_of(driver);
+    std::array<std::size_t, sizeof...(DSS)> locals;
+    for (std::size_t p = this->seek(driver, 0); p != END;
+         p = this->seek(driver, p)) {
+      Entity begin = this->global_index_of(driver, p);
+      this->dss.local_indices(begin, locals.data());
+      std::size_t limit = this->vs.contiguous_end(begin);
+      std::size_t length = this->dss.contiguous_length(locals.data());
+      if (length < limit - begin) {
+        limit = begin + length;
+      }
+
+      // Extend the run while the next position holds the next entity
+      Entity end = begin + 1;
+      for (p++; end < limit && p < extent &&
+                this->global_index_of(driver, p) == end &&
+                this->vs.contains(end) &&
+                this->dss.continues(end, end - begin, locals.data());
+           p++) {
+        end++;
+      }
+      std::apply([&](auto *... columns) { fn(begin, end, columns...); },
+                 std::tuple_cat(this->vs.data_at(begin, end - begin),
+                                this->dss.data_at(locals.data(), end - begin)));
+    }
+  }
+
+  /**
+   * Call `fn(entity, components...)` on every joined element in parallel.
+   * The positions of the driver storage are split into chunks of
+   * `PAR_CHUNK_SIZE` and run on `pool`. `fn` may modify the components it is
+   * given, but must not insert or remove.
+   */
+  template <typename F>
+  void par_for_each(ThreadPool &pool, F fn) {
+    std::size_t driver = this->plan();
+    std::size_t extent = this->extent_of(driver);
+    std::size_t num_chunks = (extent + PAR_CHUNK_SIZE - 1) / PAR_CHUNK_SIZE;
+    pool.run(num_chunks, [&](std::size_t chunk) {
+      std::size_t end = (chunk + 1) * PAR_CHUNK_SIZE;
+      for (std::size_t p = this->seek(driver, chunk * PAR_CHUNK_SIZE, end);
+           p != END; p = this->seek(driver, p + 1, end)) {
+        std::apply(fn, this->get_unchecked(this->global_index_of(driver, p)));
+      }
+    });
+  }
+
+  /**
+   * Same as `par_for_each(pool, fn)`, running on the global thread pool
+   */
+  template <typename F>
+  void par_for_each(F fn) {
+    this->par_for_each(ThreadPool::global(), fn);
+  }
+
+  /**
+   * Get the stats of every joined storage: the vec storage first, then the
+   * dense storages in the order they are joined
+   */
+  std::vector<StorageStats> stats() {
+    std::vector<StorageStats> stats = {this->vs.stats()};
+    this->dss.stats(stats);
+    return stats;
+  }
+
+  /**
+   * Get a view iterating the joined elements as `(entity, components...)`
+   * with only the components `Is...`, numbered as in
+   * `get_component_unchecked`. The joined storages are still probed, but
+   * only the chosen columns are read.
+   *
+   * Sample usage:
+   *
+   * ``` c++
+   * // Mass and hardening of particles joined with hardenings
+   * for (auto [i, m, h] : particles.join(hardenings).view<0, 3>()) {
+   *   m *= h;
+   * }
+   * ```
+   */
+  template <std::size_t... Is>
+  View<JoinedStorageViewIterator<JoinedStorageGroup<VS, DSS...>, Is...>>
+  view();
+
   JoinedStorageGroupIterator<VS, DSS...> begin();
 
   JoinedStorageGroupIterator<VS, DSS...> end();
@@ -69,33 +386,76 @@ template <class VS, class... DSS>
 class JoinedStorageGroupIterator {
 public:
   JoinedStorageGroupIterator(JoinedStorageGroup<VS, DSS...> &s) : s(s) {
-    this->index = 0;
-    while (!s.contains(this->index) && this->index < s.size()) {
-      this->index += 1;
-    }
+    this->driver = s.plan();
+    this->position = s.seek(this->driver, 0);
   }
 
   JoinedStorageGroupIterator(JoinedStorageGroup<VS, DSS...> &s, bool is_end)
-      : s(s), index(s.size()) {}
+      : s(s), driver(0), position(JoinedStorageGroup<VS, DSS...>::END) {}
 
-  auto operator*() { return this->s.get_unchecked(this->index); }
+  auto operator*() {
+    return this->s.get_unchecked(
+        this->s.global_index_of(this->driver, this->position));
+  }
 
   void operator++() {
-    this->index++;
-    while (!this->s.contains(this->index) && this->index < this->s.size()) {
-      this->index += 1;
-    }
+    this->position = this->s.seek(this->driver, this->position + 1);
   }
 
   bool operator!=(JoinedStorageGroupIterator<VS, DSS...> other) {
-    return this->index != other.index;
+    return this->position != other.position;
   }
 
 private:
-  std::size_t index;
   JoinedStorageGroup<VS, DSS...> &s;
+  std::size_t driver;
+  std::size_t position;
+};
+
+template <class JS, std::size_t... Is>
+class JoinedStorageViewIterator {
+public:
+  JoinedStorageViewIterator(JS &s) : s(s) {
+    this->driver = s.plan();
+    this->position = s.seek(this->driver, 0);
+  }
+
+  JoinedStorageViewIterator(JS &s, bool is_end)
+      : s(s), driver(0), position(JS::END) {}
+
+  auto operator*() {
+    Entity i = this->s.global_index_of(this->driver, this->position);
+    return std::tuple_cat(
+        std::make_tuple(i),
+        std::forward_as_tuple(
+            this->s.template get_component_unchecked<Is>(i)...));
+  }
+
+  void operator++() {
+    this->position = this->s.seek(this->driver, this->position + 1);
+  }
+
+  bool operator!=(JoinedStorageViewIterator<JS, Is...> other) {
+    return this->position != other.position;
+  }
+
+private:
+  // A copy of the join, which only refers to the storages, so that a view
+  // of a temporary join (`a.join(b).view<...>()`) outlives it
+  JS s;
+  std::size_t driver;
+  std::size_t position;
 };
 
+template <class VS, class... DSS>
+template <std::size_t... Is>
+View<JoinedStorageViewIterator<JoinedStorageGroup<VS, DSS...>, Is...>>
+JoinedStorageGroup<VS, DSS...>::view() {
+  using ViewIterator =
+      JoinedStorageViewIterator<JoinedStorageGroup<VS, DSS...>, Is...>;
+  return View<ViewIterator>(ViewIterator(*this), ViewIterator(*this, true));
+}
+
 template <class VS, class... DSS>
 JoinedStorageGroupIterator<VS, DSS...> JoinedStorageGroup<VS, DSS...>::begin() {
   return JoinedStorageGroupIterator(*this);
@@ -106,4 +466,4 @@ JoinedStorageGroupIterator<VS, DSS...> JoinedStorageGroup<VS, DSS...>::end() {
   return JoinedStorageGroupIterator(*this, true);
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,320 @@
+#include "Span.h"
+#include "StorageGroup.h"
+#include <algorithm>
+#include <cstdlib>
+#include <limits>
+#include <memory>
+#include <new>
+#include <string>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#ifndef MAPPED_STORAGE_H
+#define MAPPED_STORAGE_H
+
+/**
+ * The column backend storing `T` in a memory-mapped file, so that the OS
+ * pages the column in and out of RAM as it is touched. Columns that do not
+ * fit in memory, or are cold most of the time, can be mixed with in-memory
+ * ones in the same group. The file is created (and immediately unlinked) in
+ * `mapped_column_directory()`, and `T` should be bitwise copyable (see
+ * `is_bitwise_copyable`). On platforms without `mmap` the column is kept in
+ * memory.
+ *
+ * Sample usage:
+ *
+ * ``` c++
+ * // Mass and position in memory, the rest history on disk
+ * VecStorageGroup<float, Vector3f, Mapped<History>> particles;
+ * ```
+ */
+template <typename T>
+struct Mapped {};
+
+template <typename T>
+struct column_type<Mapped<T>> {
+  using Type = T;
+};
+
+/**
+ * The directory where the files of `Mapped` columns are created. Defaults
+ * to `$TMPDIR`, or `/tmp`; set it before creating the columns to move them
+ * to a larger disk.
+ */
+inline std::string &mapped_column_directory() {
+  static std::string directory =
+      std::getenv("TMPDIR") ? std::getenv("TMPDIR") : "/tmp";
+  return directory;
+}
+
+#if defined(__unix__) || defined(__APPLE__)
+
+/**
+ * A growable array of `T` in a shared mapping of an unlinked temporary
+ * file. Growing extends the file with `ftruncate` and the mapping with
+ * `mremap` (or by mapping it again where `mremap` is missing), so the
+ * existing elements are never copied through user space.
+ */
+template <typename T>
+class MappedVector {
+public:
+  static_assert(is_bitwise_copyable<T>::value,
+                "Mapped columns should be bitwise copyable");
+
+  MappedVector()
+      : fd(-1), pointer(nullptr), length(0), reserved(0), advised(0) {}
+
+  MappedVector(const MappedVector &other) : MappedVector() {
+    this->push_many(other.pointer, other.length);
+  }
+
+  MappedVector(MappedVector &&other)
+      : fd(other.fd), pointer(other.pointer), length(other.length),
+        reserved(other.reserved), advised(other.advised) {
+    other.fd = -1;
+    other.pointer = nullptr;
+    other.length = 0;
+    other.reserved = 0;
+    other.advised = 0;
+  }
+
+  MappedVector &operator=(MappedVector other) {
+    std::swap(this->fd, other.fd);
+    std::swap(this->pointer, other.pointer);
+    std::swap(this->length, other.length);
+    std::swap(this->reserved, other.reserved);
+    std::swap(this->advised, other.advised);
+    return *this;
+  }
+
+  ~MappedVector() {
+    if (this->pointer) {
+      munmap(this->pointer, this->reserved * sizeof(T));
+    }
+    if (this->fd >= 0) {
+      close(this->fd);
+    }
+  }
+
+  T &operator[](std::size_t i) { return this->pointer[i]; }
+
+  const T &operator[](std::size_t i) const { return this->pointer[i]; }
+
+  T *data() { return this->pointer; }
+
+  std::size_t size() const { return this->length; }
+
+  std::size_t capacity() const { return this->reserved; }
+
+  /**
+   * Append an element constructed in place from `args`
+   */
+  template <typename... Args>
+  void emplace_back(Args &&... args) {
+    if (this->length == this->reserved) {
+      this->remap(std::max(2 * this->reserved, MIN_CAPACITY));
+    }
+    new (this->pointer + this->length) T(std::forward<Args>(args)...);
+    this->length++;
+  }
+
+  /**
+   * Append `count` elements from `elems` as one block
+   */
+  void push_many(const T *elems, std::size_t count) {
+    if (this->length + count > this->reserved) {
+      this->remap(std::max(2 * this->reserved, this->length + count));
+    }
+    std::uninitialized_copy(elems, elems + count, this->pointer + this->length);
+    this->length += count;
+  }
+
+  /**
+   * Append `count` value-initialized elements
+   */
+  void extend(std::size_t count) {
+    if (this->length + count > this->reserved) {
+      this->remap(std::max(2 * this->reserved, this->length + count));
+    }
+    std::uninitialized_value_construct_n(this->pointer + this->length, count);
+    this->length += count;
+  }
+
+  /**
+   * Extend the file and the mapping to hold `n` elements up front
+   */
+  void reserve(std::size_t n) {
+    if (n > this->reserved) {
+      this->remap(n);
+    }
+  }
+
+  /**
+   * Drop the elements from `n` on, keeping the file size
+   */
+  void truncate(std::size_t n) { this->length = std::min(this->length, n); }
+
+  /**
+   * Shrink the file and the mapping to the elements
+   */
+  void shrink_to_fit() {
+    if (this->reserved > this->length) {
+      this->remap(this->length);
+    }
+  }
+
+  /**
+   * Advise the kernel to read ahead and drop behind when the elements are
+   * scanned. Only the elements not advised yet are, so that repeated scans
+   * cost no system call. The hint is sticky: it stays on the pages until
+   * they are remapped, so random accesses in between read ahead as well.
+   */
+  void advise_sequential() {
+    if (this->length > this->advised) {
+      // `madvise` takes whole pages, from the one holding the first new
+      // element on
+      static const std::size_t page_size = sysconf(_SC_PAGESIZE);
+      std::size_t first = this->advised * sizeof(T) / page_size * page_size;
+      madvise(reinterpret_cast<char *>(this->pointer) + first,
+              this->length * sizeof(T) - first, MADV_SEQUENTIAL);
+      this->advised = this->length;
+    }
+  }
+
+private:
+  // Grow by at least a page worth of elements
+  static constexpr std::size_t MIN_CAPACITY =
+      std::max(std::size_t(1), std::size_t(4096) / sizeof(T));
+
+  /**
+   * Resize the file and the mapping to `new_capacity` elements. Throw
+   * `std::bad_alloc` if the file cannot be created or mapped, as an
+   * allocator would.
+   */
+  void remap(std::size_t new_capacity) {
+    if (this->fd < 0) {
+      std::string path = mapped_column_directory() + "/storage_utils_XXXXXX";
+      this->fd = mkstemp(path.data());
+      if (this->fd < 0) {
+        throw std::bad_alloc();
+      }
+      unlink(path.c_str());
+    }
+    std::size_t old_bytes = this->reserved * sizeof(T);
+    std::size_t new_bytes = new_capacity * sizeof(T);
+    if (ftruncate(this->fd, new_bytes) != 0) {
+      throw std::bad_alloc();
+    }
+    void *p = nullptr;
+    if (this->pointer && new_bytes > 0) {
+#ifdef __linux__
+      p = mremap(this->pointer, old_bytes, new_bytes, MREMAP_MAYMOVE);
+#else
+      munmap(this->pointer, old_bytes);
+      p = mmap(nullptr, new_bytes, PROT_READ | PROT_WRITE, MAP_SHARED,
+               this->fd, 0);
+#endif
+    } else if (this->pointer) {
+      munmap(this->pointer, old_bytes);
+    } else if (new_bytes > 0) {
+      p = mmap(nullptr, new_bytes, PROT_READ | PROT_WRITE, MAP_SHARED,
+               this->fd, 0);
+    }
+    if (p == MAP_FAILED) {
+      throw std::bad_alloc();
+    }
+    this->pointer = static_cast<T *>(p);
+    this->reserved = new_capacity;
+    this->advised = 0;
+  }
+
+  int fd;
+  T *pointer;
+  std::size_t length;
+  std::size_t reserved;
+  // The number of elements advised sequential since the last remap
+  std::size_t advised;
+};
+
+template <std::size_t Index, typename T, typename Alloc>
+class Storage<Index, Mapped<T>, Alloc> {
+public:
+  Storage() {}
+
+  T &get(Entity i) { return this->data[i]; }
+
+  /**
+   * Get the element `i` for reading
+   */
+  const T &peek(Entity i) { return this->data[i]; }
+
+  void set(Entity i, const T &elem) { this->data[i] = elem; }
+
+  void set(Entity i, T &&elem) { this->data[i] = std::move(elem); }
+
+  /**
+   * Set the element `i` of a row added by `extend`
+   */
+  template <typename U>
+  void fill(Entity i, U &&elem) {
+    this->data[i] = std::forward<U>(elem);
+  }
+
+  void push(const T &elem) { this->data.emplace_back(elem); }
+
+  void push(T &&elem) { this->data.emplace_back(std::move(elem)); }
+
+  template <typename... Args>
+  void emplace(Args &&... args) {
+    this->data.emplace_back(std::forward<Args>(args)...);
+  }
+
+  void push_many(const T *elems, std::size_t count) {
+    this->data.push_many(elems, count);
+  }
+
+  void extend(std::size_t count) { this->data.extend(count); }
+
+  void reserve(std::size_t n) { this->data.reserve(n); }
+
+  std::size_t capacity() const { return this->data.capacity(); }
+
+  void swap(Entity i, Entity j) { std::swap(this->data[i], this->data[j]); }
+
+  void relocate(Entity from, Entity to) {
+    this->data[to] = std::move(this->data[from]);
+  }
+
+  void truncate(std::size_t n) { this->data.truncate(n); }
+
+  void shrink_to_fit() { this->data.shrink_to_fit(); }
+
+  void advise_sequential() { this->data.advise_sequential(); }
+
+  std::size_t contiguous_end(Entity i) const {
+    return std::numeric_limits<std::size_t>::max();
+  }
+
+  T *data_at(Entity i, std::size_t count) { return this->data.data() + i; }
+
+  /**
+   * Get the contiguous view of the whole column
+   */
+  Span<T> span() { return Span<T>(this->data.data(), this->data.size()); }
+
+private:
+  MappedVector<T> data;
+};
+
+#else
+
+template <std::size_t Index, typename T, typename Alloc>
+class Storage<Index, Mapped<T>, Alloc> : public Storage<Index, T, Alloc> {};
+
+#endif
+
+#endif
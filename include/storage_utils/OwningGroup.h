@@ -0,0 +1,232 @@
+#include "Span.h"
+#include "SparseIndex.h"
+#include "StorageGroup.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <tuple>
+#include <utility>
+
+#ifndef OWNING_GROUP_H
+#define OWNING_GROUP_H
+
+template <class VS, class... DSS>
+class OwningGroupIterator;
+
+/**
+ * A join of one vec storage group with dense storage groups that owns the
+ * dense storages: the elements of the entities contained in every storage
+ * are kept at the front of each dense storage, in the same order. Iterating
+ * the group is then a lockstep walk over the first `size()` elements of the
+ * dense columns, with the vec components read at the entity, and no
+ * `contains` probe at all. The elements are yielded as
+ * `(entity, vec components..., dense components...)`, the same as a
+ * `JoinedStorageGroup`.
+ *
+ * The order is maintained incrementally. Insert and remove through the
+ * group, or call `include` after inserting into one of the owned storages
+ * and `exclude` before removing from it. Sorting an owned dense storage
+ * breaks the order.
+ *
+ * Sample usage:
+ *
+ * ``` c++
+ * auto group = particles.own(deformations);
+ * Entity i = group.insert(1.0, Vector2f(0.0, 0.0));
+ * group.insert_into<0>(i, 0.0, 1.0);
+ * for (auto [i, m, x, tc, ts] : group) {
+ *   // ...
+ * }
+ * ```
+ */
+template <class VS, class... DSS>
+class OwningGroup {
+public:
+  static_assert(sizeof...(DSS) > 0, "Own at least one dense storage");
+
+  OwningGroup(VS &vs, DSS &... dss) : vs(vs), dss(dss...), num_owned(0) {
+    auto &first = std::get<0>(this->dss);
+    for (std::size_t k = 0; k < first.size(); k++) {
+      this->include(first.get_global_index(k));
+    }
+  }
+
+  OwningGroup(const OwningGroup &) = delete;
+
+  OwningGroup &operator=(const OwningGroup &) = delete;
+
+  /**
+   * Get the number of entities contained in every storage
+   */
+  std::size_t size() const { return this->num_owned; }
+
+  /**
+   * Check if entity `i` is contained in every storage
+   */
+  bool contains(Entity i) {
+    auto local_index = std::get<0>(this->dss).get_local_index(i);
+    return local_index != SparseIndex::NONE && local_index < this->num_owned;
+  }
+
+  /**
+   * Bring entity `i` into the group if it is now contained in every
+   * storage. Call it after inserting `i` into one of the storages directly.
+   */
+  void include(Entity i) {
+    bool in_all = std::apply(
+        [&](DSS &... dss) { return (dss.contains(i) && ...); }, this->dss);
+    if (in_all && this->vs.contains(i) && !this->contains(i)) {
+      std::apply(
+          [&](DSS &... dss) {
+            (dss.swap_local(dss.get_local_index(i), this->num_owned), ...);
+          },
+          this->dss);
+      this->num_owned++;
+    }
+  }
+
+  /**
+   * Take entity `i` out of the group. Call it before removing `i` from one
+   * of the storages directly.
+   */
+  void exclude(Entity i) {
+    if (this->contains(i)) {
+      this->num_owned--;
+      std::apply(
+          [&](DSS &... dss) {
+            (dss.swap_local(dss.get_local_index(i), this->num_owned), ...);
+          },
+          this->dss);
+    }
+  }
+
+  /**
+   * Insert into the vec storage (see `VecStorageGroup::emplace`), and return
+   * the entity
+   */
+  template <typename... Args>
+  Entity insert(Args &&... args) {
+    Entity i = this->vs.emplace(std::forward<Args>(args)...);
+    this->include(i);
+    return i;
+  }
+
+  /**
+   * Remove entity `i` from the vec storage
+   */
+  bool remove(Entity i) {
+    this->exclude(i);
+    return this->vs.remove(i);
+  }
+
+  /**
+   * Insert entity `i` into the `D`th owned dense storage (see
+   * `DenseStorageGroup::emplace`)
+   */
+  template <std::size_t D, typename... Args>
+  void insert_into(Entity i, Args &&... args) {
+    std::get<D>(this->dss).emplace(i, std::forward<Args>(args)...);
+    this->include(i);
+  }
+
+  /**
+   * Remove entity `i` from the `D`th owned dense storage
+   */
+  template <std::size_t D>
+  bool remove_from(Entity i) {
+    this->exclude(i);
+    return std::get<D>(this->dss).remove(i);
+  }
+
+  /**
+   * Get the entities of the group, in order
+   */
+  Span<const Entity> entities() {
+    return std::get<0>(this->dss).entities().first(this->num_owned);
+  }
+
+  /**
+   * Get the view of the component column `Index` of the `D`th owned dense
+   * storage, restricted to the group; element `k` belongs to `entities()[k]`
+   */
+  template <std::size_t D, std::size_t Index>
+  auto column() {
+    return std::get<D>(this->dss)
+        .template column<Index>()
+        .first(this->num_owned);
+  }
+
+  /**
+   * Get the `k`th element of the group as
+   * `(entity, vec components..., dense components...)`
+   */
+  auto get_at(std::size_t k) {
+    Entity i = std::get<0>(this->dss).get_global_index(k);
+    auto dense = std::apply(
+        [&](DSS &... dss) { return std::tuple_cat(dss.get_local(k)...); },
+        this->dss);
+    return std::tuple_cat(std::make_tuple(i), this->vs.get_unchecked(i),
+                          dense);
+  }
+
+  /**
+   * Call `fn(entity, components...)` on every element of the group in
+   * parallel, in chunks of `PAR_CHUNK_SIZE` run on `pool`. `fn` may modify
+   * the components it is given, but must not insert or remove.
+   */
+  template <typename F>
+  void par_for_each(ThreadPool &pool, F fn) {
+    std::size_t size = this->num_owned;
+    std::size_t num_chunks = (size + PAR_CHUNK_SIZE - 1) / PAR_CHUNK_SIZE;
+    pool.run(num_chunks, [&](std::size_t chunk) {
+      std::size_t end = std::min(size, (chunk + 1) * PAR_CHUNK_SIZE);
+      for (std::size_t k = chunk * PAR_CHUNK_SIZE; k < end; k++) {
+        std::apply(fn, this->get_at(k));
+      }
+    });
+  }
+
+  /**
+   * Same as `par_for_each(pool, fn)`, running on the global thread pool
+   */
+  template <typename F>
+  void par_for_each(F fn) {
+    this->par_for_each(ThreadPool::global(), fn);
+  }
+
+  OwningGroupIterator<VS, DSS...> begin() {
+    return OwningGroupIterator<VS, DSS...>(*this, 0);
+  }
+
+  OwningGroupIterator<VS, DSS...> end() {
+    return OwningGroupIterator<VS, DSS...>(*this, this->num_owned);
+  }
+
+private:
+  VS &vs;
+  std::tuple<DSS &...> dss;
+
+  // The number of elements at the front of every dense storage that belong
+  // to the group
+  std::size_t num_owned;
+};
+
+template <class VS, class... DSS>
+class OwningGroupIterator {
+public:
+  OwningGroupIterator(OwningGroup<VS, DSS...> &group, std::size_t k)
+      : group(group), k(k) {}
+
+  auto operator*() { return this->group.get_at(this->k); }
+
+  void operator++() { this->k++; }
+
+  bool operator!=(const OwningGroupIterator<VS, DSS...> &other) {
+    return this->k != other.k;
+  }
+
+private:
+  OwningGroup<VS, DSS...> &group;
+  std::size_t k;
+};
+
+#endif
@@ -0,0 +1,285 @@
+#include "StorageGroup.h"
+#include <algorithm>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+#ifndef PAGED_STORAGE_H
+#define PAGED_STORAGE_H
+
+/**
+ * The column backend storing `T` in fixed-size pages of `PageSize` elements
+ * (a power of two). Growing the column only allocates a new page: nothing is
+ * copied, and the address of every element stays stable across inserts.
+ *
+ * Sample usage:
+ *
+ * ``` c++
+ * // Mass in a plain vector, position and velocity in pages
+ * VecStorageGroup<float, Paged<Vector3f>, Paged<Vector3f>> particles;
+ * ```
+ */
+template <typename T, std::size_t PageSize = 4096>
+struct Paged {
+  static_assert(PageSize > 0 && (PageSize & (PageSize - 1)) == 0,
+                "The page size should be a power of two");
+};
+
+template <typename T, std::size_t PageSize>
+struct column_type<Paged<T, PageSize>> {
+  using Type = T;
+};
+
+/**
+ * A non-owning view over a paged column. Elements are contiguous within
+ * each page, so inner loops should walk `page(p)` for every page `p`.
+ */
+template <typename T, std::size_t PageSize>
+class PagedSpan {
+public:
+  static constexpr std::size_t PAGE_SIZE = PageSize;
+
+  PagedSpan(T *const *pages, std::size_t length)
+      : pages(pages), length(length) {}
+
+  std::size_t size() const { return this->length; }
+
+  bool empty() const { return this->length == 0; }
+
+  std::size_t num_pages() const {
+    return (this->length + PageSize - 1) / PageSize;
+  }
+
+  T &operator[](std::size_t i) const {
+    return this->pages[i / PageSize][i % PageSize];
+  }
+
+  /**
+   * Get the contiguous view of the `p`th page. Only the last page may hold
+   * fewer than `PAGE_SIZE` elements.
+   */
+  Span<T> page(std::size_t p) const {
+    return Span<T>(this->pages[p],
+                   std::min(PageSize, this->length - p * PageSize));
+  }
+
+  /**
+   * Get the view of the first `count` elements
+   */
+  PagedSpan<T, PageSize> first(std::size_t count) const {
+    return PagedSpan<T, PageSize>(this->pages, count);
+  }
+
+private:
+  T *const *pages;
+  std::size_t length;
+};
+
+/**
+ * A growable array of `T` allocated in pages of `PageSize` elements through
+ * `Allocator`
+ */
+template <typename T, std::size_t PageSize, typename Allocator>
+class PagedVector {
+public:
+  PagedVector() : length(0) {}
+
+  PagedVector(const PagedVector &other)
+      : allocator(other.allocator), length(0) {
+    for (std::size_t i = 0; i < other.length; i++) {
+      this->push_back(other[i]);
+    }
+  }
+
+  PagedVector(PagedVector &&other)
+      : allocator(std::move(other.allocator)), pages(std::move(other.pages)),
+        length(other.length) {
+    other.pages.clear();
+    other.length = 0;
+  }
+
+  PagedVector &operator=(PagedVector other) {
+    std::swap(this->allocator, other.allocator);
+    std::swap(this->pages, other.pages);
+    std::swap(this->length, other.length);
+    return *this;
+  }
+
+  ~PagedVector() {
+    for (std::size_t i = 0; i < this->length; i++) {
+      (*this)[i].~T();
+    }
+    for (T *page : this->pages) {
+      this->allocator.deallocate(page, PageSize);
+    }
+  }
+
+  T &operator[](std::size_t i) {
+    return this->pages[i / PageSize][i % PageSize];
+  }
+
+  const T &operator[](std::size_t i) const {
+    return this->pages[i / PageSize][i % PageSize];
+  }
+
+  void push_back(const T &elem) { this->emplace_back(elem); }
+
+  /**
+   * Append an element constructed in place from `args`
+   */
+  template <typename... Args>
+  void emplace_back(Args &&... args) {
+    if (this->length == this->pages.size() * PageSize) {
+      this->pages.push_back(this->allocator.allocate(PageSize));
+    }
+    new (&(*this)[this->length]) T(std::forward<Args>(args)...);
+    this->length++;
+  }
+
+  /**
+   * Append `count` elements from `elems`, copying one page-sized block at a
+   * time
+   */
+  void push_many(const T *elems, std::size_t count) {
+    this->reserve(this->length + count);
+    while (count > 0) {
+      std::size_t offset = this->length % PageSize;
+      std::size_t block = std::min(count, PageSize - offset);
+      std::uninitialized_copy(elems, elems + block,
+                              this->pages[this->length / PageSize] + offset);
+      this->length += block;
+      elems += block;
+      count -= block;
+    }
+  }
+
+  /**
+   * Append `count` value-initialized elements
+   */
+  void extend(std::size_t count) {
+    this->reserve(this->length + count);
+    for (; count > 0; count--) {
+      new (&(*this)[this->length]) T();
+      this->length++;
+    }
+  }
+
+  /**
+   * Allocate the pages for `n` elements up front
+   */
+  void reserve(std::size_t n) {
+    while (this->pages.size() * PageSize < n) {
+      this->pages.push_back(this->allocator.allocate(PageSize));
+    }
+  }
+
+  /**
+   * Destroy the elements from `n` on, keeping their pages
+   */
+  void truncate(std::size_t n) {
+    for (std::size_t i = n; i < this->length; i++) {
+      (*this)[i].~T();
+    }
+    this->length = std::min(this->length, n);
+  }
+
+  /**
+   * Free the pages past the last element
+   */
+  void shrink_to_fit() {
+    std::size_t num_used = (this->length + PageSize - 1) / PageSize;
+    while (this->pages.size() > num_used) {
+      this->allocator.deallocate(this->pages.back(), PageSize);
+      this->pages.pop_back();
+    }
+  }
+
+  std::size_t size() const { return this->length; }
+
+  std::size_t capacity() const { return this->pages.size() * PageSize; }
+
+  PagedSpan<T, PageSize> span() {
+    return PagedSpan<T, PageSize>(this->pages.data(), this->length);
+  }
+
+private:
+  Allocator allocator;
+  std::vector<T *> pages;
+  std::size_t length;
+};
+
+template <std::size_t Index, typename T, std::size_t PageSize, typename Alloc>
+class Storage<Index, Paged<T, PageSize>, Alloc> {
+public:
+  Storage() {}
+
+  T &get(Entity i) { return this->data[i]; }
+
+  /**
+   * Get the element `i` for reading
+   */
+  const T &peek(Entity i) { return this->data[i]; }
+
+  void set(Entity i, const T &elem) { this->data[i] = elem; }
+
+  void set(Entity i, T &&elem) { this->data[i] = std::move(elem); }
+
+  /**
+   * Set the element `i` of a row added by `extend`
+   */
+  template <typename U>
+  void fill(Entity i, U &&elem) {
+    this->data[i] = std::forward<U>(elem);
+  }
+
+  void push(const T &elem) { this->data.emplace_back(elem); }
+
+  void push(T &&elem) { this->data.emplace_back(std::move(elem)); }
+
+  template <typename... Args>
+  void emplace(Args &&... args) {
+    this->data.emplace_back(std::forward<Args>(args)...);
+  }
+
+  void push_many(const T *elems, std::size_t count) {
+    this->data.push_many(elems, count);
+  }
+
+  void extend(std::size_t count) { this->data.extend(count); }
+
+  void reserve(std::size_t n) { this->data.reserve(n); }
+
+  std::size_t capacity() const { return this->data.capacity(); }
+
+  void swap(Entity i, Entity j) { std::swap(this->data[i], this->data[j]); }
+
+  void relocate(Entity from, Entity to) {
+    this->data[to] = std::move(this->data[from]);
+  }
+
+  void truncate(std::size_t n) { this->data.truncate(n); }
+
+  void shrink_to_fit() { this->data.shrink_to_fit(); }
+
+  void advise_sequential() {}
+
+  /**
+   * Get the end of the page containing element `i`
+   */
+  std::size_t contiguous_end(Entity i) const {
+    return (i / PageSize + 1) * PageSize;
+  }
+
+  T *data_at(Entity i, std::size_t count) { return &this->data[i]; }
+
+  /**
+   * Get the paged view of the whole column
+   */
+  PagedSpan<T, PageSize> span() { return this->data.span(); }
+
+private:
+  PagedVector<T, PageSize, typename Alloc::template Allocator<T>> data;
+};
+
+#endif
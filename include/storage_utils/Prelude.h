@@ -1,4 +1,17 @@
+#include "Allocator.h"
+#include "CommandBuffer.h"
+#include "ConcurrentAppender.h"
 #include "DenseStorageGroup.h"
 #include "JoinedStorageGroup.h"
+#include "MappedStorage.h"
+#include "OwningGroup.h"
+#include "PagedStorage.h"
+#include "ReusePolicy.h"
+#include "ShardedVecStorageGroup.h"
+#include "Snapshot.h"
+#include "Span.h"
 #include "StorageGroup.h"
+#include "ThreadPool.h"
+#include "TiledStorage.h"
+#include "TrackedStorage.h"
 #include "VecStorageGroup.h"
\ No newline at end of file
@@ -0,0 +1,100 @@
+#include "StorageGroup.h"
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+#ifndef REUSE_POLICY_H
+#define REUSE_POLICY_H
+
+/**
+ * The free-slot reuse policies of `BasicVecStorageGroup`. A policy receives
+ * every removed slot through `push`, and is asked for a slot to fill through
+ * `pop` whenever it is not `empty`. All policies share the interface
+ *
+ * ``` c++
+ * bool empty();
+ * void push(Entity i);
+ * Entity pop();
+ * void clear();
+ * std::size_t capacity_bytes() const; // The memory held, for `stats()`
+ * ```
+ */
+
+/**
+ * Reuse the most recently removed slot first. O(1) insert and remove, and the
+ * refilled slot is likely to still be in cache.
+ */
+class LifoReuse {
+public:
+  bool empty() { return this->free_indices.empty(); }
+
+  void push(Entity i) { this->free_indices.push_back(i); }
+
+  Entity pop() {
+    Entity i = this->free_indices.back();
+    this->free_indices.pop_back();
+    return i;
+  }
+
+  void clear() { this->free_indices.clear(); }
+
+  std::size_t capacity_bytes() const {
+    return this->free_indices.capacity() * sizeof(Entity);
+  }
+
+private:
+  std::vector<Entity> free_indices;
+};
+
+/**
+ * Reuse the lowest removed slot first, using a min-heap. O(log n) insert and
+ * remove, but the live slots stay packed at the front of the storage.
+ */
+class LowestIndexFirstReuse {
+public:
+  bool empty() { return this->free_indices.empty(); }
+
+  void push(Entity i) {
+    this->free_indices.push_back(i);
+    std::push_heap(this->free_indices.begin(), this->free_indices.end(),
+                   std::greater<Entity>());
+  }
+
+  Entity pop() {
+    std::pop_heap(this->free_indices.begin(), this->free_indices.end(),
+                  std::greater<Entity>());
+    Entity i = this->free_indices.back();
+    this->free_indices.pop_back();
+    return i;
+  }
+
+  void clear() { this->free_indices.clear(); }
+
+  std::size_t capacity_bytes() const {
+    return this->free_indices.capacity() * sizeof(Entity);
+  }
+
+private:
+  // A min-heap of the removed slots
+  std::vector<Entity> free_indices;
+};
+
+/**
+ * Never reuse a removed slot; always append to the end of the storage. The
+ * holes are left in place until the storage is compacted, so the order of
+ * insertion is kept and no bookkeeping is needed on removal.
+ */
+class AppendOnlyReuse {
+public:
+  bool empty() { return true; }
+
+  void push(Entity) {}
+
+  Entity pop() { return 0; }
+
+  void clear() {}
+
+  std::size_t capacity_bytes() const { return 0; }
+};
+
+#endif
@@ -0,0 +1,368 @@
+#include "JoinedStorageGroup.h"
+#include "ReusePolicy.h"
+#include "StorageGroup.h"
+#include "ThreadPool.h"
+#include "VecStorageGroup.h"
+#include <algorithm>
+#include <optional>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#ifndef SHARDED_VEC_STORAGE_GROUP_H
+#define SHARDED_VEC_STORAGE_GROUP_H
+
+template <class SVS>
+class ShardedVecStorageGroupIterator {
+public:
+  ShardedVecStorageGroupIterator(SVS &storage, std::size_t index)
+      : storage(storage), index(index) {}
+
+  auto operator*() {
+    return std::tuple_cat(std::make_tuple(this->index),
+                          this->storage.get_unchecked(this->index));
+  }
+
+  void operator++() { this->index = this->storage.find_next(this->index + 1); }
+
+  bool operator!=(ShardedVecStorageGroupIterator<SVS> other) {
+    return this->index != other.index;
+  }
+
+private:
+  SVS &storage;
+  std::size_t index;
+};
+
+/**
+ * A vec storage group split into shards, so that several threads can insert
+ * and remove at the same time without a lock, each in its own shard. Shard
+ * `s` owns the entities `[s << shard_bits, (s + 1) << shard_bits)`, and has
+ * its own columns, liveness mask and free slots (a `BasicVecStorageGroup`),
+ * kept on separate cache lines.
+ *
+ * Calls on entities of different shards may run concurrently; `insert`
+ * takes the shard to insert into. The calls spanning all the shards (`size`,
+ * iteration, `join`, ...) see one storage indexed by global entities, with
+ * the unused ids at the end of every shard skipped, and should not run
+ * concurrently with inserts or removes.
+ *
+ * Sample usage:
+ *
+ * ``` c++
+ * ShardedVecStorageGroup<float, Vector2f> particles(pool.num_threads());
+ * pool.run(pool.num_threads(), [&](std::size_t shard) {
+ *   for (Entity i : expired[shard]) {
+ *     particles.remove(i);
+ *     particles.insert(shard, 1.0, random_point());
+ *   }
+ * });
+ * for (auto [i, m, x, h] : particles.join(hardenings)) {
+ *   // ...
+ * }
+ * ```
+ */
+template <typename Reuse, typename Alloc, typename... Types>
+class BasicShardedVecStorageGroup {
+public:
+  // The storage of one shard, indexed by the entities local to the shard
+  using Shard = BasicVecStorageGroup<Reuse, Alloc, Types...>;
+
+  template <std::size_t Index>
+  using TypeAt = typename Shard::template TypeAt<Index>;
+
+  using Bulk = typename Shard::Bulk;
+
+  using BulkRef = typename Shard::BulkRef;
+
+  using Iterator = ShardedVecStorageGroupIterator<
+      BasicShardedVecStorageGroup<Reuse, Alloc, Types...>>;
+
+  // The default number of entity bits local to a shard
+  static constexpr std::size_t DEFAULT_SHARD_BITS = 20;
+
+  /**
+   * Create `num_shards` empty shards of up to `1 << shard_bits` elements
+   */
+  BasicShardedVecStorageGroup(std::size_t num_shards,
+                              std::size_t shard_bits = DEFAULT_SHARD_BITS)
+      : shards(std::max(num_shards, std::size_t(1))), shard_bits(shard_bits) {}
+
+  std::size_t num_shards() const { return this->shards.size(); }
+
+  /**
+   * Get the number of entities owned by every shard
+   */
+  std::size_t shard_capacity() const {
+    return std::size_t(1) << this->shard_bits;
+  }
+
+  /**
+   * Get the shard owning entity `i`
+   */
+  std::size_t shard_of(Entity i) const { return i >> this->shard_bits; }
+
+  /**
+   * Insert the data (as function arguments) into the shard `shard`. Return
+   * the entity, or `None` if the shard is full or there's no such shard.
+   */
+  std::optional<Entity> insert(std::size_t shard,
+                               ComponentType<Types>... args) {
+    return this->emplace_bulk(shard,
+                              std::forward_as_tuple(std::move(args)...));
+  }
+
+  /**
+   * Same as `insert`, with the components constructed from `args` (see
+   * `VecStorageGroup::emplace`)
+   */
+  template <typename... Args>
+  std::optional<Entity> emplace(std::size_t shard, Args &&... args) {
+    return this->emplace_bulk(
+        shard, std::forward_as_tuple(std::forward<Args>(args)...));
+  }
+
+  template <typename Tuple>
+  std::optional<Entity> emplace_bulk(std::size_t shard, Tuple &&args) {
+    if (shard >= this->shards.size()) {
+      return {};
+    }
+    Shard &storage = this->shards[shard].storage;
+    if (!storage.has_free_slot() &&
+        storage._max_size() >= this->shard_capacity()) {
+      return {};
+    }
+    Entity local = storage.emplace_bulk(std::forward<Tuple>(args));
+    return (shard << this->shard_bits) + local;
+  }
+
+  /**
+   * Reserve every shard for `n` slots
+   */
+  void reserve(std::size_t n) {
+    for (auto &shard : this->shards) {
+      shard.storage.reserve(n);
+    }
+  }
+
+  bool remove(Entity i) {
+    Shard *storage = this->shard_at(i);
+    return storage && storage->remove(this->local(i));
+  }
+
+  bool update(Entity i, ComponentType<Types>... args) {
+    Shard *storage = this->shard_at(i);
+    return storage && storage->update_bulk(
+                          this->local(i), Bulk(std::move(args)...));
+  }
+
+  std::optional<BulkRef> get(Entity i) {
+    Shard *storage = this->shard_at(i);
+    if (storage) {
+      return storage->get(this->local(i));
+    }
+    return {};
+  }
+
+  BulkRef get_unchecked(Entity i) {
+    return this->shards[this->shard_of(i)].storage.get_unchecked(
+        this->local(i));
+  }
+
+  template <std::size_t Index>
+  std::optional<TypeAt<Index>> get_component(Entity i) {
+    Shard *storage = this->shard_at(i);
+    if (storage) {
+      return storage->template get_component<Index>(this->local(i));
+    }
+    return {};
+  }
+
+  template <std::size_t Index>
+  TypeAt<Index> &get_component_unchecked(Entity i) {
+    return this->shards[this->shard_of(i)]
+        .storage.template get_component_unchecked<Index>(this->local(i));
+  }
+
+  bool contains(Entity i) {
+    Shard *storage = this->shard_at(i);
+    return storage && storage->contains(this->local(i));
+  }
+
+  /**
+   * Get the first valid entity at `i` or after, across the shards. Return
+   * `_max_size()` if there is none.
+   */
+  Entity find_next(Entity i) {
+    for (std::size_t s = this->shard_of(i); s < this->shards.size(); s++) {
+      Entity base = s << this->shard_bits;
+      Shard &storage = this->shards[s].storage;
+      Entity local = storage.find_next(i > base ? i - base : 0);
+      if (local < storage._max_size()) {
+        return base + local;
+      }
+    }
+    return this->_max_size();
+  }
+
+  /**
+   * Get the number of valid elements in all the shards
+   */
+  std::size_t size() {
+    std::size_t size = 0;
+    for (auto &shard : this->shards) {
+      size += shard.storage.size();
+    }
+    return size;
+  }
+
+  /**
+   * [Experimental] Get the end of the entities in use: one past the last
+   * slot of the last non-empty shard
+   */
+  std::size_t _max_size() {
+    for (std::size_t s = this->shards.size(); s > 0; s--) {
+      std::size_t max_size = this->shards[s - 1].storage._max_size();
+      if (max_size > 0) {
+        return ((s - 1) << this->shard_bits) + max_size;
+      }
+    }
+    return 0;
+  }
+
+  bool is_empty() { return this->size() == 0; }
+
+  Iterator begin() { return Iterator(*this, this->find_next(0)); }
+
+  Iterator end() { return Iterator(*this, this->_max_size()); }
+
+  /**
+   * Get a view iterating the valid elements with only the component columns
+   * `Is...` (see `VecStorageGroup::view`)
+   */
+  template <std::size_t... Is>
+  View<VecStorageViewIterator<
+      BasicShardedVecStorageGroup<Reuse, Alloc, Types...>, Is...>>
+  view() {
+    using ViewIterator = VecStorageViewIterator<
+        BasicShardedVecStorageGroup<Reuse, Alloc, Types...>, Is...>;
+    return View<ViewIterator>(ViewIterator(*this, this->find_next(0)),
+                              ViewIterator(*this, this->_max_size()));
+  }
+
+  /**
+   * Call `fn(begin, end, columns...)` on every run of valid entities, shard
+   * by shard (see `VecStorageGroup::for_each_chunk`). Runs never cross a
+   * shard.
+   */
+  template <typename F>
+  void for_each_chunk(F fn) {
+    for (std::size_t s = 0; s < this->shards.size(); s++) {
+      Entity base = s << this->shard_bits;
+      this->shards[s].storage.for_each_chunk(
+          [&](Entity begin, Entity end, auto *... columns) {
+            fn(base + begin, base + end, columns...);
+          });
+    }
+  }
+
+  /**
+   * Get the end of the block of entities from `i` on that is contiguous in
+   * every column, which is at most the end of the shard of `i`
+   */
+  std::size_t contiguous_end(Entity i) {
+    Entity base = this->shard_of(i) << this->shard_bits;
+    std::size_t end = std::min(
+        this->shards[this->shard_of(i)].storage.contiguous_end(i - base),
+        this->shard_capacity());
+    return base + end;
+  }
+
+  auto data_at(Entity i, std::size_t count) {
+    return this->shards[this->shard_of(i)].storage.data_at(this->local(i),
+                                                           count);
+  }
+
+  /**
+   * Call `fn(entity, components...)` on every valid element in parallel,
+   * one task per shard, so that `fn` only touches the elements of one shard
+   * at a time
+   */
+  template <typename F>
+  void par_for_each(ThreadPool &pool, F fn) {
+    pool.run(this->shards.size(), [&](std::size_t s) {
+      Entity base = s << this->shard_bits;
+      for (auto row : this->shards[s].storage) {
+        std::get<0>(row) += base;
+        std::apply(fn, row);
+      }
+    });
+  }
+
+  /**
+   * Same as `par_for_each(pool, fn)`, running on the global thread pool
+   */
+  template <typename F>
+  void par_for_each(F fn) {
+    this->par_for_each(ThreadPool::global(), fn);
+  }
+
+  /**
+   * Get the memory footprint and fragmentation of all the shards together
+   * (see `VecStorageGroup::stats`). The dead runs are measured within each
+   * shard.
+   */
+  StorageStats stats() {
+    StorageStats stats;
+    for (auto &shard : this->shards) {
+      StorageStats shard_stats = shard.storage.stats();
+      stats.size += shard_stats.size;
+      stats.slots += shard_stats.slots;
+      stats.index_bytes += shard_stats.index_bytes;
+      stats.longest_dead_run =
+          std::max(stats.longest_dead_run, shard_stats.longest_dead_run);
+      stats.columns.resize(shard_stats.columns.size());
+      for (std::size_t c = 0; c < shard_stats.columns.size(); c++) {
+        stats.columns[c].used_bytes += shard_stats.columns[c].used_bytes;
+        stats.columns[c].capacity_bytes +=
+            shard_stats.columns[c].capacity_bytes;
+      }
+    }
+    return stats;
+  }
+
+  template <class... DSS>
+  JoinedStorageGroup<BasicShardedVecStorageGroup<Reuse, Alloc, Types...>,
+                     DSS...>
+  join(DSS &... dss) {
+    return JoinedStorageGroup(*this, dss...);
+  }
+
+private:
+  // A shard on cache lines of its own, so that threads updating the sizes of
+  // neighbouring shards never falsely share
+  struct alignas(64) ShardSlot {
+    Shard storage;
+  };
+
+  /**
+   * Get the shard owning entity `i`, or `nullptr` if there's none
+   */
+  Shard *shard_at(Entity i) {
+    std::size_t s = this->shard_of(i);
+    return s < this->shards.size() ? &this->shards[s].storage : nullptr;
+  }
+
+  Entity local(Entity i) const {
+    return i & (this->shard_capacity() - 1);
+  }
+
+  std::vector<ShardSlot> shards;
+  std::size_t shard_bits;
+};
+
+template <typename... Types>
+using ShardedVecStorageGroup =
+    BasicShardedVecStorageGroup<LifoReuse, DefaultAlloc, Types...>;
+
+#endif
@@ -0,0 +1,446 @@
+#include "Allocator.h"
+#include "BitSet.h"
+#include "PagedStorage.h"
+#include "Span.h"
+#include "StorageGroup.h"
+#include "TiledStorage.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+/**
+ * The binary snapshot format of the storage groups, version
+ * `SNAPSHOT_VERSION`. All the fields are in the byte order of the machine
+ * that wrote them, which the byte order marker tells apart: snapshots of
+ * the other byte order are rejected rather than swapped. Every section
+ * starts at a multiple of `SNAPSHOT_ALIGNMENT` bytes so that a mapped file
+ * can be viewed in place.
+ *
+ *   magic           8 bytes, `SNAPSHOT_MAGIC`
+ *   byte order      u32, `SNAPSHOT_BYTE_ORDER`
+ *   version         u32
+ *   kind            u32, `SnapshotKind`
+ *   entity size     u32, `sizeof(Entity)`
+ *   num columns     u64
+ *   num slots       u64, `_max_size()` of a vec storage, `size()` of a dense
+ *   num valid       u64, `size()`
+ *   column layout   u64 size and u64 alignment of every component type
+ *   liveness        (vec) the words of the liveness mask
+ *   entities        (dense) the entity of every element
+ *   columns         the raw elements of every column, removed slots included
+ */
+constexpr char SNAPSHOT_MAGIC[8] = {'S', 'U', 'S', 'N', 'A', 'P', '\0', '\0'};
+
+constexpr std::uint32_t SNAPSHOT_BYTE_ORDER = 0x01020304;
+
+constexpr std::uint32_t SNAPSHOT_VERSION = 1;
+
+constexpr std::size_t SNAPSHOT_ALIGNMENT = 64;
+
+enum class SnapshotKind : std::uint32_t { Vec = 0, Dense = 1 };
+
+/**
+ * Write the sections of a snapshot to a stream, padding each one to
+ * `SNAPSHOT_ALIGNMENT`
+ */
+class SnapshotWriter {
+public:
+  SnapshotWriter(std::ostream &out) : out(out), offset(0) {}
+
+  void write(const void *data, std::size_t size) {
+    this->out.write(static_cast<const char *>(data), size);
+    this->offset += size;
+  }
+
+  template <typename T>
+  void write_value(T value) {
+    this->write(&value, sizeof(T));
+  }
+
+  template <typename T>
+  void write_column(Span<T> column) {
+    this->write(column.data(), column.size() * sizeof(T));
+    this->pad();
+  }
+
+  template <typename T, std::size_t PageSize>
+  void write_column(PagedSpan<T, PageSize> column) {
+    for (std::size_t p = 0; p < column.num_pages(); p++) {
+      Span<T> page = column.page(p);
+      this->write(page.data(), page.size() * sizeof(T));
+    }
+    this->pad();
+  }
+
+  template <typename T, std::size_t Lanes>
+  void write_column(TiledSpan<T, Lanes> column) {
+    for (std::size_t t = 0; t < column.num_tiles(); t++) {
+      Span<T> tile = column.tile(t);
+      this->write(tile.data(), tile.size() * sizeof(T));
+    }
+    this->pad();
+  }
+
+  void pad() {
+    static const char zeros[SNAPSHOT_ALIGNMENT] = {};
+    std::size_t misalignment = this->offset % SNAPSHOT_ALIGNMENT;
+    if (misalignment != 0) {
+      this->write(zeros, SNAPSHOT_ALIGNMENT - misalignment);
+    }
+  }
+
+  bool good() const { return this->out.good(); }
+
+private:
+  std::ostream &out;
+  std::size_t offset;
+};
+
+/**
+ * Write the header of a snapshot of `Types` columns
+ */
+template <typename... Types>
+void write_snapshot_header(SnapshotWriter &writer, SnapshotKind kind,
+                           std::size_t num_slots, std::size_t num_valid) {
+  static_assert((is_bitwise_copyable<ComponentType<Types>>::value && ...),
+                "Only bitwise copyable components can be snapshotted");
+  writer.write(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+  writer.write_value<std::uint32_t>(SNAPSHOT_BYTE_ORDER);
+  writer.write_value<std::uint32_t>(SNAPSHOT_VERSION);
+  writer.write_value<std::uint32_t>(static_cast<std::uint32_t>(kind));
+  writer.write_value<std::uint32_t>(sizeof(Entity));
+  writer.write_value<std::uint64_t>(sizeof...(Types));
+  writer.write_value<std::uint64_t>(num_slots);
+  writer.write_value<std::uint64_t>(num_valid);
+  (writer.write_value<std::uint64_t>(sizeof(ComponentType<Types>)), ...);
+  (writer.write_value<std::uint64_t>(alignof(ComponentType<Types>)), ...);
+  writer.pad();
+}
+
+/**
+ * Read the sections of a snapshot from its bytes, checking every section
+ * against the end of the bytes
+ */
+class SnapshotReader {
+public:
+  SnapshotReader(const char *data, std::size_t size)
+      : data(data), size(size), offset(0) {}
+
+  /**
+   * Take the next `count` elements of type `T`, or `nullptr` if the bytes
+   * end before them
+   */
+  template <typename T>
+  const T *take(std::size_t count) {
+    if (count > (this->size - this->offset) / sizeof(T)) {
+      return nullptr;
+    }
+    const T *elems = reinterpret_cast<const T *>(this->data + this->offset);
+    this->offset += count * sizeof(T);
+    return elems;
+  }
+
+  template <typename T>
+  bool read_value(T &value) {
+    const T *pointer = this->take<T>(1);
+    if (pointer) {
+      std::memcpy(&value, pointer, sizeof(T));
+    }
+    return pointer != nullptr;
+  }
+
+  void pad() {
+    this->offset = std::min(
+        this->size, (this->offset + SNAPSHOT_ALIGNMENT - 1) /
+                        SNAPSHOT_ALIGNMENT * SNAPSHOT_ALIGNMENT);
+  }
+
+private:
+  const char *data;
+  std::size_t size;
+  std::size_t offset;
+};
+
+/**
+ * A read-only file mapped into memory. Falls back to reading the file into
+ * an aligned buffer on platforms without `mmap`.
+ */
+class MappedFile {
+public:
+  MappedFile() : pointer(nullptr), length(0) {}
+
+  MappedFile(const MappedFile &) = delete;
+
+  MappedFile(MappedFile &&other)
+      : pointer(other.pointer), length(other.length),
+        buffer(std::move(other.buffer)) {
+    other.pointer = nullptr;
+    other.length = 0;
+  }
+
+  MappedFile &operator=(MappedFile other) {
+    std::swap(this->pointer, other.pointer);
+    std::swap(this->length, other.length);
+    std::swap(this->buffer, other.buffer);
+    return *this;
+  }
+
+  ~MappedFile() {
+#if defined(__unix__) || defined(__APPLE__)
+    if (this->pointer && this->buffer.empty()) {
+      munmap(const_cast<char *>(this->pointer), this->length);
+    }
+#endif
+  }
+
+  /**
+   * Map the file at `path`. Return `false` if it cannot be opened.
+   */
+  bool open(const std::string &path) {
+    *this = MappedFile();
+#if defined(__unix__) || defined(__APPLE__)
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+      void *p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (p != MAP_FAILED) {
+        this->pointer = static_cast<const char *>(p);
+        this->length = st.st_size;
+      }
+    }
+    ::close(fd);
+    return this->pointer != nullptr;
+#else
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) {
+      return false;
+    }
+    this->buffer.resize(in.tellg());
+    in.seekg(0);
+    in.read(this->buffer.data(), this->buffer.size());
+    this->pointer = this->buffer.data();
+    this->length = this->buffer.size();
+    return in.good() && this->length > 0;
+#endif
+  }
+
+  const char *data() const { return this->pointer; }
+
+  std::size_t size() const { return this->length; }
+
+private:
+  const char *pointer;
+  std::size_t length;
+  std::vector<char, AlignedAllocator<char, SNAPSHOT_ALIGNMENT>> buffer;
+};
+
+/**
+ * A read-only view of a snapshot of a storage group with the columns
+ * `Types`, in place over the bytes of the snapshot. Opening a snapshot file
+ * maps it into memory, so the columns are iterated without being
+ * deserialized and are only paged in as they are touched. Use
+ * `VecStorageGroup::restore` or `DenseStorageGroup::restore` to load the
+ * snapshot into a storage group instead.
+ *
+ * Sample usage:
+ *
+ * ``` c++
+ * particles.save(out); // VecStorageGroup<float, Vector2f> particles
+ * auto snapshot = SnapshotView<float, Vector2f>::open("particles.bin");
+ * if (snapshot) {
+ *   Span<const float> masses = snapshot->column<0>();
+ * }
+ * ```
+ */
+template <typename... Types>
+class SnapshotView {
+public:
+  // The helper type `TypeAt<Index>` for the component type of a column
+  template <std::size_t Index>
+  using TypeAt =
+      ComponentType<typename extract_type_at<Index, Types...>::Type>;
+
+  /**
+   * Map the snapshot file at `path`. Return `None` if the file cannot be
+   * opened, or is not a snapshot of `Types` columns.
+   */
+  static std::optional<SnapshotView> open(const std::string &path) {
+    MappedFile file;
+    if (!file.open(path)) {
+      return {};
+    }
+    auto view = SnapshotView::from_bytes(file.data(), file.size());
+    if (view) {
+      view->file = std::move(file);
+    }
+    return view;
+  }
+
+  /**
+   * View the snapshot in `size` bytes at `data`, which should be aligned to
+   * `SNAPSHOT_ALIGNMENT` and outlive the view. Return `None` if the bytes are
+   * not a snapshot of `Types` columns.
+   */
+  static std::optional<SnapshotView> from_bytes(const void *data,
+                                                std::size_t size) {
+    SnapshotView view;
+    SnapshotReader reader(static_cast<const char *>(data), size);
+    const char *magic = reader.take<char>(sizeof(SNAPSHOT_MAGIC));
+    std::uint32_t byte_order, version, kind, entity_size;
+    std::uint64_t num_columns, num_slots, num_valid;
+    if (!magic ||
+        std::memcmp(magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0 ||
+        !reader.read_value(byte_order) || byte_order != SNAPSHOT_BYTE_ORDER ||
+        !reader.read_value(version) || version != SNAPSHOT_VERSION ||
+        !reader.read_value(kind) || kind > 1 ||
+        !reader.read_value(entity_size) || entity_size != sizeof(Entity) ||
+        !reader.read_value(num_columns) || num_columns != sizeof...(Types) ||
+        !reader.read_value(num_slots) || !reader.read_value(num_valid) ||
+        num_valid > num_slots) {
+      return {};
+    }
+
+    // Check the layout of the columns
+    const std::uint64_t *layout = reader.take<std::uint64_t>(2 * num_columns);
+    std::uint64_t sizes[] = {sizeof(ComponentType<Types>)...};
+    std::uint64_t alignments[] = {alignof(ComponentType<Types>)...};
+    if (!layout ||
+        !std::equal(sizes, sizes + num_columns, layout) ||
+        !std::equal(alignments, alignments + num_columns,
+                    layout + num_columns)) {
+      return {};
+    }
+    reader.pad();
+
+    view.kind = static_cast<SnapshotKind>(kind);
+    view.num_slots = num_slots;
+    view.num_valid = num_valid;
+    if (view.kind == SnapshotKind::Vec) {
+      std::size_t num_words =
+          (num_slots + BitSet::WORD_BITS - 1) / BitSet::WORD_BITS;
+      const BitSet::Word *words = reader.take<BitSet::Word>(num_words);
+      if (!words) {
+        return {};
+      }
+
+      // The valid elements should be the set bits, none past the last slot
+      std::size_t num_alive = 0;
+      for (std::size_t w = 0; w < num_words; w++) {
+        num_alive += count_ones(words[w]);
+      }
+      if (num_alive != num_valid ||
+          (num_slots % BitSet::WORD_BITS != 0 &&
+           words[num_words - 1] >> (num_slots % BitSet::WORD_BITS) != 0)) {
+        return {};
+      }
+      view.alive = Span<const BitSet::Word>(words, num_words);
+    } else {
+      const Entity *entities = reader.take<Entity>(num_slots);
+      if (!entities || num_valid != num_slots) {
+        return {};
+      }
+      view.global_indices = Span<const Entity>(entities, num_slots);
+    }
+    reader.pad();
+    if (!view.read_columns(reader, std::index_sequence_for<Types...>())) {
+      return {};
+    }
+    return view;
+  }
+
+  SnapshotKind snapshot_kind() const { return this->kind; }
+
+  /**
+   * Get the number of valid elements
+   */
+  std::size_t size() const { return this->num_valid; }
+
+  /**
+   * Get the number of slots of every column, the removed ones included
+   */
+  std::size_t _max_size() const { return this->num_slots; }
+
+  /**
+   * Check if slot `i` of a vec storage snapshot holds a valid element
+   */
+  bool contains(Entity i) const {
+    return i < this->num_slots &&
+           ((this->alive[i / BitSet::WORD_BITS] >> (i % BitSet::WORD_BITS)) &
+            1);
+  }
+
+  /**
+   * Get the liveness mask of a vec storage snapshot, laid out as
+   * `VecStorageGroup::liveness()`
+   */
+  Span<const BitSet::Word> liveness() const { return this->alive; }
+
+  /**
+   * Get the entity of every element of a dense storage snapshot, laid out as
+   * `DenseStorageGroup::entities()`
+   */
+  Span<const Entity> entities() const { return this->global_indices; }
+
+  /**
+   * Get the view of the component column `Index`
+   */
+  template <std::size_t Index>
+  Span<const TypeAt<Index>> column() const {
+    return std::get<Index>(this->columns);
+  }
+
+  /**
+   * Get the views of all the columns
+   */
+  const std::tuple<Span<const ComponentType<Types>>...> &all_columns() const {
+    return this->columns;
+  }
+
+private:
+  SnapshotView() : kind(SnapshotKind::Vec), num_slots(0), num_valid(0) {}
+
+  template <std::size_t... Indices>
+  bool read_columns(SnapshotReader &reader, std::index_sequence<Indices...>) {
+    return (this->read_column<Indices>(reader) && ...);
+  }
+
+  template <std::size_t Index>
+  bool read_column(SnapshotReader &reader) {
+    const TypeAt<Index> *elems = reader.take<TypeAt<Index>>(this->num_slots);
+    std::get<Index>(this->columns) =
+        Span<const TypeAt<Index>>(elems, this->num_slots);
+    reader.pad();
+    return elems != nullptr;
+  }
+
+  SnapshotKind kind;
+  std::size_t num_slots;
+  std::size_t num_valid;
+  Span<const BitSet::Word> alive;
+  Span<const Entity> global_indices;
+  std::tuple<Span<const ComponentType<Types>>...> columns;
+  MappedFile file;
+};
+
+#endif
@@ -0,0 +1,58 @@
+#include <cstddef>
+#include <utility>
+
+#ifndef SPAN_H
+#define SPAN_H
+
+/**
+ * A non-owning view over `size()` contiguous elements, standing in for the
+ * C++20 `std::span`. The view is invalidated by anything that reallocates
+ * the underlying storage (e.g. inserting into the storage group).
+ */
+template <typename T>
+class Span {
+public:
+  Span() : pointer(nullptr), length(0) {}
+
+  Span(T *pointer, std::size_t length) : pointer(pointer), length(length) {}
+
+  /**
+   * View the elements of a contiguous container (e.g. a `std::vector`)
+   */
+  template <typename Container,
+            typename = decltype(std::declval<Container &>().data())>
+  Span(Container &container)
+      : pointer(container.data()), length(container.size()) {}
+
+  T *data() const { return this->pointer; }
+
+  std::size_t size() const { return this->length; }
+
+  bool empty() const { return this->length == 0; }
+
+  T &operator[](std::size_t i) const { return this->pointer[i]; }
+
+  T *begin() const { return this->pointer; }
+
+  T *end() const { return this->pointer + this->length; }
+
+  /**
+   * Get the view of the first `count` elements
+   */
+  Span<T> first(std::size_t count) const {
+    return Span<T>(this->pointer, count);
+  }
+
+  /**
+   * Get the view of `count` elements starting at `offset`
+   */
+  Span<T> subspan(std::size_t offset, std::size_t count) const {
+    return Span<T>(this->pointer + offset, count);
+  }
+
+private:
+  T *pointer;
+  std::size_t length;
+};
+
+#endif
\ No newline at end of file
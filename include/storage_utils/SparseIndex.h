@@ -0,0 +1,116 @@
+#include "StorageGroup.h"
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#ifndef SPARSE_INDEX_H
+#define SPARSE_INDEX_H
+
+/**
+ * A map from entity to 32-bit local index, stored as a lazily allocated page
+ * table. A page of `PAGE_SIZE` local indices is only allocated once an
+ * entity in its range is set, so the memory is proportional to the entity
+ * ranges actually used rather than to the largest entity. Missing entries
+ * hold the sentinel `NONE`.
+ */
+class SparseIndex {
+public:
+  using LocalIndex = std::uint32_t;
+
+  // The local index of an entity that is not in the map
+  static constexpr LocalIndex NONE = std::numeric_limits<LocalIndex>::max();
+
+  static constexpr std::size_t PAGE_BITS = 12;
+
+  static constexpr std::size_t PAGE_SIZE = std::size_t(1) << PAGE_BITS;
+
+  SparseIndex() {}
+
+  SparseIndex(const SparseIndex &other) { *this = other; }
+
+  SparseIndex(SparseIndex &&other) = default;
+
+  SparseIndex &operator=(const SparseIndex &other) {
+    this->pages.clear();
+    for (auto &page : other.pages) {
+      if (page) {
+        this->pages.push_back(std::make_unique<LocalIndex[]>(PAGE_SIZE));
+        std::copy(page.get(), page.get() + PAGE_SIZE, this->pages.back().get());
+      } else {
+        this->pages.emplace_back();
+      }
+    }
+    return *this;
+  }
+
+  SparseIndex &operator=(SparseIndex &&other) = default;
+
+  /**
+   * Get the local index of entity `i`, or `NONE` if there's none
+   */
+  LocalIndex get(Entity i) const {
+    std::size_t page = i >> PAGE_BITS;
+    if (page < this->pages.size() && this->pages[page]) {
+      return this->pages[page][i & (PAGE_SIZE - 1)];
+    }
+    return NONE;
+  }
+
+  /**
+   * Get the local index of entity `i`, which should be in the map
+   */
+  LocalIndex get_unchecked(Entity i) const {
+    return this->pages[i >> PAGE_BITS][i & (PAGE_SIZE - 1)];
+  }
+
+  bool contains(Entity i) const { return this->get(i) != NONE; }
+
+  /**
+   * Map entity `i` to `local_index`, allocating its page if needed
+   */
+  void set(Entity i, LocalIndex local_index) {
+    std::size_t page = i >> PAGE_BITS;
+    if (page >= this->pages.size()) {
+      this->pages.resize(page + 1);
+    }
+    if (!this->pages[page]) {
+      this->pages[page] = std::make_unique<LocalIndex[]>(PAGE_SIZE);
+      std::fill(this->pages[page].get(), this->pages[page].get() + PAGE_SIZE,
+                NONE);
+    }
+    this->pages[page][i & (PAGE_SIZE - 1)] = local_index;
+  }
+
+  /**
+   * Remove entity `i` from the map
+   */
+  void reset(Entity i) {
+    std::size_t page = i >> PAGE_BITS;
+    if (page < this->pages.size() && this->pages[page]) {
+      this->pages[page][i & (PAGE_SIZE - 1)] = NONE;
+    }
+  }
+
+  /**
+   * Get the number of entities covered by the page table (allocated or not)
+   */
+  std::size_t extent() const { return this->pages.size() * PAGE_SIZE; }
+
+  /**
+   * Get the memory held by the page table and the allocated pages
+   */
+  std::size_t capacity_bytes() const {
+    std::size_t bytes = this->pages.capacity() * sizeof(this->pages[0]);
+    for (auto &page : this->pages) {
+      bytes += page ? PAGE_SIZE * sizeof(LocalIndex) : 0;
+    }
+    return bytes;
+  }
+
+private:
+  std::vector<std::unique_ptr<LocalIndex[]>> pages;
+};
+
+#endif
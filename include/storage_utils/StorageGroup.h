@@ -1,5 +1,10 @@
+#include "Allocator.h"
+#include "Span.h"
 #include <algorithm>
 #include <cstddef>
+#include <limits>
+#include <tuple>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
@@ -8,73 +13,408 @@
 
 using Entity = std::size_t;
 
-template <std::size_t Index, typename T>
+/**
+ * An entity moved from `from` to `to` by a compaction
+ */
+struct EntityMove {
+  Entity from;
+  Entity to;
+};
+
+/**
+ * The moves made by one compaction, in the order they were made
+ */
+using EntityRemap = std::vector<EntityMove>;
+
+/**
+ * The memory use of a column: the bytes of the elements in use, and of all
+ * the elements the column can hold without growing
+ */
+struct ColumnStats {
+  std::size_t used_bytes;
+  std::size_t capacity_bytes;
+};
+
+/**
+ * The memory footprint and fragmentation of a storage group, as reported by
+ * `stats()`
+ */
+struct StorageStats {
+  // The number of valid elements
+  std::size_t size = 0;
+
+  // The number of slots of every column, valid or not
+  std::size_t slots = 0;
+
+  // The memory use of every column, in order
+  std::vector<ColumnStats> columns;
+
+  // The memory held by the index structures (liveness mask, free slots,
+  // entity maps)
+  std::size_t index_bytes = 0;
+
+  // The length of the longest run of consecutive removed slots
+  std::size_t longest_dead_run = 0;
+
+  /**
+   * Get the fraction of the slots holding valid elements
+   */
+  double live_ratio() const {
+    return this->slots ? double(this->size) / this->slots : 1.0;
+  }
+
+  /**
+   * Get the memory held by the columns and the index structures
+   */
+  std::size_t capacity_bytes() const {
+    std::size_t bytes = this->index_bytes;
+    for (const ColumnStats &column : this->columns) {
+      bytes += column.capacity_bytes;
+    }
+    return bytes;
+  }
+};
+
+/**
+ * The component type stored in a column declared as `Column`. Column
+ * backends wrapping a component type (e.g. `Paged<T>`) specialize this to
+ * unwrap it; plain component types are stored as themselves.
+ */
+template <typename Column>
+struct column_type {
+  using Type = Column;
+};
+
+template <typename Column>
+using ComponentType = typename column_type<Column>::Type;
+
+/**
+ * Whether a component type can be copied as its raw bytes. True for
+ * trivially copyable types, and for tuples and pairs of such types (which
+ * are not trivially copyable only because of their assignment operators).
+ * Specialize it to allow other types with the same property.
+ */
+template <typename T>
+struct is_bitwise_copyable : std::is_trivially_copyable<T> {};
+
+template <typename... Types>
+struct is_bitwise_copyable<std::tuple<Types...>>
+    : std::conjunction<is_bitwise_copyable<Types>...> {};
+
+template <typename T, typename U>
+struct is_bitwise_copyable<std::pair<T, U>>
+    : std::conjunction<is_bitwise_copyable<T>, is_bitwise_copyable<U>> {};
+
+template <std::size_t Index, typename T, typename Alloc = DefaultAlloc>
 class Storage {
 public:
   Storage() {}
 
   T &get(Entity i) { return this->data[i]; }
 
-  void set(Entity i, T elem) { this->data[i] = elem; }
+  /**
+   * Get the element `i` for reading
+   */
+  const T &peek(Entity i) { return this->data[i]; }
 
-  void push(T elem) { this->data.push_back(elem); }
+  void set(Entity i, const T &elem) { this->data[i] = elem; }
+
+  void set(Entity i, T &&elem) { this->data[i] = std::move(elem); }
+
+  /**
+   * Set the element `i` of a row added by `extend`
+   */
+  template <typename U>
+  void fill(Entity i, U &&elem) {
+    this->data[i] = std::forward<U>(elem);
+  }
+
+  void push(const T &elem) { this->data.push_back(elem); }
+
+  void push(T &&elem) { this->data.push_back(std::move(elem)); }
+
+  /**
+   * Append an element constructed in place from `args`
+   */
+  template <typename... Args>
+  void emplace(Args &&... args) {
+    this->data.emplace_back(std::forward<Args>(args)...);
+  }
+
+  /**
+   * Append `count` elements from `elems` as one block
+   */
+  void push_many(const T *elems, std::size_t count) {
+    this->data.insert(this->data.end(), elems, elems + count);
+  }
+
+  /**
+   * Append `count` value-initialized elements, to be set later
+   */
+  void extend(std::size_t count) {
+    this->data.resize(this->data.size() + count);
+  }
+
+  void reserve(std::size_t n) { this->data.reserve(n); }
+
+  /**
+   * Get the number of elements the column can hold without growing
+   */
+  std::size_t capacity() const { return this->data.capacity(); }
 
   void swap(Entity i, Entity j) { std::swap(this->data[i], this->data[j]); }
 
+  /**
+   * Move the element `from` into the element `to`
+   */
+  void relocate(Entity from, Entity to) {
+    this->data[to] = std::move(this->data[from]);
+  }
+
+  /**
+   * Destroy the elements from `n` on, keeping the capacity
+   */
+  void truncate(std::size_t n) {
+    this->data.erase(this->data.begin() + n, this->data.end());
+  }
+
+  void shrink_to_fit() { this->data.shrink_to_fit(); }
+
+  /**
+   * Hint that the column is about to be scanned in order
+   */
+  void advise_sequential() {}
+
+  /**
+   * Get the end of the block of contiguous elements containing element `i`
+   */
+  std::size_t contiguous_end(Entity i) const {
+    return std::numeric_limits<std::size_t>::max();
+  }
+
+  /**
+   * Get the pointer to the `count` elements from `i` on, which should lie in
+   * one contiguous block
+   */
+  T *data_at(Entity i, std::size_t count) { return this->data.data() + i; }
+
+  /**
+   * Get the contiguous view of the whole column
+   */
+  Span<T> span() { return Span<T>(this->data.data(), this->data.size()); }
+
 private:
-  std::vector<T> data;
+  std::vector<T, typename Alloc::template Allocator<T>> data;
 };
 
-template <std::size_t Index, typename... Types>
+template <std::size_t Index, typename Alloc, typename... Types>
 class StorageGroupBase {
 public:
   std::tuple<> get_bulk(Entity i) { return std::make_tuple(); }
 
-  template <typename... AllTypes>
-  void set_bulk(Entity i, const std::tuple<AllTypes...> &args) {}
+  template <typename Tuple>
+  void set_bulk(Entity i, Tuple &&args) {}
+
+  template <typename Tuple>
+  void fill_bulk(Entity i, Tuple &&args) {}
 
-  template <typename... AllTypes>
-  void push_bulk(const std::tuple<AllTypes...> &args) {}
+  template <typename Tuple>
+  void push_bulk(Tuple &&args) {}
+
+  template <typename... Columns>
+  void set_from(Entity i, const std::tuple<Columns...> &columns,
+                std::size_t k) {}
+
+  template <typename... Columns>
+  void push_many(const std::tuple<Columns...> &columns, std::size_t offset,
+                 std::size_t count) {}
+
+  void extend(std::size_t count) {}
+
+  void reserve(std::size_t n) {}
+
+  void column_stats(std::vector<ColumnStats> &columns, std::size_t size) {}
 
   void swap(Entity i, Entity j) {}
+
+  void relocate(Entity from, Entity to) {}
+
+  void truncate(std::size_t n) {}
+
+  void shrink_to_fit() {}
+
+  void advise_sequential() {}
+
+  std::size_t contiguous_end(Entity i) {
+    return std::numeric_limits<std::size_t>::max();
+  }
+
+  std::tuple<> data_at(Entity i, std::size_t count) {
+    return std::make_tuple();
+  }
 };
 
-template <std::size_t Index, typename T, typename... Types>
-class StorageGroupBase<Index, T, Types...>
-    : public Storage<Index, T>, public StorageGroupBase<Index + 1, Types...> {
+template <std::size_t Index, typename Alloc, typename T, typename... Types>
+class StorageGroupBase<Index, Alloc, T, Types...>
+    : public Storage<Index, T, Alloc>,
+      public StorageGroupBase<Index + 1, Alloc, Types...> {
 public:
   static constexpr std::size_t SIZE = sizeof...(Types) + 1;
 
   StorageGroupBase()
-      : Storage<Index, T>(), StorageGroupBase<Index + 1, Types...>() {}
+      : Storage<Index, T, Alloc>(),
+        StorageGroupBase<Index + 1, Alloc, Types...>() {}
 
-  std::tuple<T &, Types &...> get_bulk(Entity i) {
-    std::tuple<Types &...> rs =
-        StorageGroupBase<Index + 1, Types...>::get_bulk(i);
-    T &hd = Storage<Index, T>::get(i);
+  std::tuple<ComponentType<T> &, ComponentType<Types> &...>
+  get_bulk(Entity i) {
+    std::tuple<ComponentType<Types> &...> rs =
+        StorageGroupBase<Index + 1, Alloc, Types...>::get_bulk(i);
+    ComponentType<T> &hd = Storage<Index, T, Alloc>::get(i);
     return std::tuple_cat(std::tie(hd), rs);
   }
 
-  template <typename... AllTypes>
-  void set_bulk(Entity i, const std::tuple<AllTypes...> &args) {
-    Storage<Index, T>::set(i, std::get<Index>(args));
-    StorageGroupBase<Index + 1, Types...>::set_bulk(i, args);
+  /**
+   * Set the element `i` of every column from the matching element of `args`.
+   * Elements of an rvalue tuple (or rvalue references within the tuple, as
+   * made by `std::forward_as_tuple`) are moved instead of copied.
+   */
+  template <typename Tuple>
+  void set_bulk(Entity i, Tuple &&args) {
+    Storage<Index, T, Alloc>::set(i,
+                                  std::get<Index>(std::forward<Tuple>(args)));
+    StorageGroupBase<Index + 1, Alloc, Types...>::set_bulk(
+        i, std::forward<Tuple>(args));
+  }
+
+  /**
+   * Set the element `i` of every column, in a row added by `extend`, the
+   * same way as `set_bulk`. `Tracked` columns do not mark it again, so rows
+   * can be filled from several threads at once.
+   */
+  template <typename Tuple>
+  void fill_bulk(Entity i, Tuple &&args) {
+    Storage<Index, T, Alloc>::fill(i,
+                                   std::get<Index>(std::forward<Tuple>(args)));
+    StorageGroupBase<Index + 1, Alloc, Types...>::fill_bulk(
+        i, std::forward<Tuple>(args));
+  }
+
+  /**
+   * Append to every column an element constructed in place from the matching
+   * element of `args`, forwarded the same way as in `set_bulk`
+   */
+  template <typename Tuple>
+  void push_bulk(Tuple &&args) {
+    Storage<Index, T, Alloc>::emplace(
+        std::get<Index>(std::forward<Tuple>(args)));
+    StorageGroupBase<Index + 1, Alloc, Types...>::push_bulk(
+        std::forward<Tuple>(args));
+  }
+
+  /**
+   * Set the element `i` of every column to element `k` of the matching span
+   * in `columns`
+   */
+  template <typename... Columns>
+  void set_from(Entity i, const std::tuple<Columns...> &columns,
+                std::size_t k) {
+    Storage<Index, T, Alloc>::set(i, std::get<Index>(columns)[k]);
+    StorageGroupBase<Index + 1, Alloc, Types...>::set_from(i, columns, k);
+  }
+
+  /**
+   * Append the elements `[offset, offset + count)` of the matching span in
+   * `columns` to every column, one block per column
+   */
+  template <typename... Columns>
+  void push_many(const std::tuple<Columns...> &columns, std::size_t offset,
+                 std::size_t count) {
+    auto elems = std::get<Index>(columns).data() + offset;
+    Storage<Index, T, Alloc>::push_many(elems, count);
+    StorageGroupBase<Index + 1, Alloc, Types...>::push_many(columns, offset,
+                                                            count);
+  }
+
+  /**
+   * Append `count` value-initialized elements to every column
+   */
+  void extend(std::size_t count) {
+    Storage<Index, T, Alloc>::extend(count);
+    StorageGroupBase<Index + 1, Alloc, Types...>::extend(count);
   }
 
-  template <typename... AllTypes>
-  void push_bulk(const std::tuple<AllTypes...> &args) {
-    Storage<Index, T>::push(std::get<Index>(args));
-    StorageGroupBase<Index + 1, Types...>::push_bulk(args);
+  void reserve(std::size_t n) {
+    Storage<Index, T, Alloc>::reserve(n);
+    StorageGroupBase<Index + 1, Alloc, Types...>::reserve(n);
+  }
+
+  /**
+   * Append the memory use of every column, `size` elements of which are in
+   * use, to `columns`
+   */
+  void column_stats(std::vector<ColumnStats> &columns, std::size_t size) {
+    using C = ComponentType<T>;
+    std::size_t capacity = Storage<Index, T, Alloc>::capacity();
+    columns.push_back({size * sizeof(C), capacity * sizeof(C)});
+    StorageGroupBase<Index + 1, Alloc, Types...>::column_stats(columns, size);
   }
 
   void swap(Entity i, Entity j) {
-    Storage<Index, T>::swap(i, j);
-    StorageGroupBase<Index + 1, Types...>::swap(i, j);
+    Storage<Index, T, Alloc>::swap(i, j);
+    StorageGroupBase<Index + 1, Alloc, Types...>::swap(i, j);
+  }
+
+  void relocate(Entity from, Entity to) {
+    Storage<Index, T, Alloc>::relocate(from, to);
+    StorageGroupBase<Index + 1, Alloc, Types...>::relocate(from, to);
+  }
+
+  void truncate(std::size_t n) {
+    Storage<Index, T, Alloc>::truncate(n);
+    StorageGroupBase<Index + 1, Alloc, Types...>::truncate(n);
+  }
+
+  void shrink_to_fit() {
+    Storage<Index, T, Alloc>::shrink_to_fit();
+    StorageGroupBase<Index + 1, Alloc, Types...>::shrink_to_fit();
+  }
+
+  void advise_sequential() {
+    Storage<Index, T, Alloc>::advise_sequential();
+    StorageGroupBase<Index + 1, Alloc, Types...>::advise_sequential();
+  }
+
+  /**
+   * Get the end of the block of elements containing `i` that is contiguous
+   * in every column
+   */
+  std::size_t contiguous_end(Entity i) {
+    return std::min(
+        Storage<Index, T, Alloc>::contiguous_end(i),
+        StorageGroupBase<Index + 1, Alloc, Types...>::contiguous_end(i));
+  }
+
+  /**
+   * Get the pointers to the `count` elements from `i` on in every column,
+   * which should lie in one contiguous block (see `contiguous_end`)
+   */
+  auto data_at(Entity i, std::size_t count) {
+    return std::tuple_cat(
+        std::make_tuple(Storage<Index, T, Alloc>::data_at(i, count)),
+        StorageGroupBase<Index + 1, Alloc, Types...>::data_at(i, count));
   }
 };
 
-template <typename T, typename... Types>
-struct StorageGroup : StorageGroupBase<0, T, Types...> {};
+/**
+ * A group of columns, one per type, all allocated through the `Alloc` policy
+ * (see `Allocator.h`). A type can be wrapped in a column backend (e.g.
+ * `Paged<T>`) to store that column differently.
+ */
+template <typename Alloc, typename T, typename... Types>
+struct BasicStorageGroup : StorageGroupBase<0, Alloc, T, Types...> {};
+
+template <typename... Types>
+using StorageGroup = BasicStorageGroup<DefaultAlloc, Types...>;
 
 template <std::size_t Index, typename T, typename... Args>
 struct extract_type_at {
@@ -86,4 +426,22 @@ struct extract_type_at<0, T, Args...> {
   using Type = T;
 };
 
+/**
+ * A range given by a pair of iterators, as returned by the `view` of the
+ * storage groups
+ */
+template <typename Iterator>
+class View {
+public:
+  View(Iterator first, Iterator last) : first(first), last(last) {}
+
+  Iterator begin() { return this->first; }
+
+  Iterator end() { return this->last; }
+
+private:
+  Iterator first;
+  Iterator last;
+};
+
 #endif
\ No newline at end of file
@@ -0,0 +1,168 @@
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+// The number of slots handed to a worker at a time by `par_for_each`. This is
+// a multiple of 64 so that two chunks never share a liveness word, and so that
+// every chunk of a column starts on a cache line boundary of its (aligned)
+// column base. Workers writing to neighbouring chunks never falsely share.
+constexpr std::size_t PAR_CHUNK_SIZE = 1024;
+
+/**
+ * A work-stealing pool of threads. `run` splits the tasks evenly into one
+ * queue per thread; each thread takes tasks from the front of its own queue,
+ * and once that is drained, steals from the back of the other queues.
+ *
+ * The thread calling `run` participates as the first worker, so a pool of
+ * `n` threads spawns `n - 1` background threads and a pool of `1` thread
+ * runs every task inline.
+ */
+class ThreadPool {
+public:
+  explicit ThreadPool(
+      std::size_t num_threads = std::thread::hardware_concurrency())
+      : generation(0), pending(0), stop(false) {
+    num_threads = std::max(num_threads, std::size_t(1));
+    for (std::size_t i = 0; i < num_threads; i++) {
+      this->queues.push_back(std::make_unique<Queue>());
+    }
+    for (std::size_t i = 1; i < num_threads; i++) {
+      this->threads.emplace_back([this, i] { this->worker(i); });
+    }
+  }
+
+  ThreadPool(const ThreadPool &) = delete;
+
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  ~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      this->stop = true;
+    }
+    this->start_cv.notify_all();
+    for (auto &thread : this->threads) {
+      thread.join();
+    }
+  }
+
+  std::size_t num_threads() const { return this->queues.size(); }
+
+  /**
+   * Run `task(t)` for every `t` in `[0, num_tasks)` and block until all of
+   * them are finished. Tasks may run concurrently and in any order. `run`
+   * must not be called from inside a task.
+   */
+  template <typename F>
+  void run(std::size_t num_tasks, F task) {
+    if (num_tasks == 0) {
+      return;
+    }
+    std::lock_guard<std::mutex> run_lock(this->run_mutex);
+    {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      this->job = std::ref(task);
+      this->pending = num_tasks;
+      std::size_t n = this->queues.size();
+      for (std::size_t i = 0; i < n; i++) {
+        std::lock_guard<std::mutex> queue_lock(this->queues[i]->mutex);
+        this->queues[i]->begin = i * num_tasks / n;
+        this->queues[i]->end = (i + 1) * num_tasks / n;
+      }
+      this->generation++;
+    }
+    this->start_cv.notify_all();
+    this->work(0);
+    std::unique_lock<std::mutex> lock(this->mutex);
+    this->done_cv.wait(lock, [this] { return this->pending == 0; });
+  }
+
+  /**
+   * The pool shared by all the `par_for_each` calls that are not given one.
+   * Has one thread per hardware thread.
+   */
+  static ThreadPool &global() {
+    static ThreadPool pool;
+    return pool;
+  }
+
+private:
+  // The tasks `[begin, end)` remaining in the queue of one thread
+  struct Queue {
+    std::mutex mutex;
+    std::size_t begin = 0;
+    std::size_t end = 0;
+  };
+
+  std::vector<std::unique_ptr<Queue>> queues;
+  std::vector<std::thread> threads;
+
+  std::mutex run_mutex;
+  std::mutex mutex;
+  std::condition_variable start_cv;
+  std::condition_variable done_cv;
+  std::function<void(std::size_t)> job;
+  std::size_t generation;
+  std::atomic<std::size_t> pending;
+  bool stop;
+
+  void worker(std::size_t id) {
+    std::size_t seen = 0;
+    while (true) {
+      {
+        std::unique_lock<std::mutex> lock(this->mutex);
+        this->start_cv.wait(lock, [this, seen] {
+          return this->stop || this->generation != seen;
+        });
+        if (this->stop) {
+          return;
+        }
+        seen = this->generation;
+      }
+      this->work(id);
+    }
+  }
+
+  void work(std::size_t id) {
+    std::size_t task;
+    while (this->pop(id, task)) {
+      this->job(task);
+      if (--this->pending == 0) {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->done_cv.notify_all();
+      }
+    }
+  }
+
+  bool pop(std::size_t id, std::size_t &task) {
+    std::size_t n = this->queues.size();
+    {
+      Queue &own = *this->queues[id];
+      std::lock_guard<std::mutex> lock(own.mutex);
+      if (own.begin < own.end) {
+        task = own.begin++;
+        return true;
+      }
+    }
+    for (std::size_t i = 1; i < n; i++) {
+      Queue &victim = *this->queues[(id + i) % n];
+      std::lock_guard<std::mutex> lock(victim.mutex);
+      if (victim.begin < victim.end) {
+        task = --victim.end;
+        return true;
+      }
+    }
+    return false;
+  }
+};
+
+#endif
@@ -0,0 +1,492 @@
+#include "Allocator.h"
+#include "Span.h"
+#include "StorageGroup.h"
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <new>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#ifndef TILED_STORAGE_H
+#define TILED_STORAGE_H
+
+/**
+ * The layout policy storing a group in tiles of `Lanes` rows (AoSoA): a tile
+ * holds the `Lanes` elements of the first column, then those of the second
+ * column, and so on. A kernel touching every component of a row then reads
+ * from one region of memory instead of one stream per column, while a loop
+ * over one column still reads `Lanes` contiguous elements at a time (see
+ * `for_each_chunk`). The tiles are allocated through `Alloc`, and the
+ * components should be bitwise copyable (see `is_bitwise_copyable`).
+ *
+ * It takes the place of the allocation policy of a storage group, and every
+ * column of the group is tiled. The columns should be plain component types,
+ * not backends such as `Paged<T>`.
+ *
+ * Sample usage:
+ *
+ * ``` c++
+ * // Mass, position and velocity, in tiles of 16 particles
+ * using Particles =
+ *     BasicVecStorageGroup<LifoReuse, AoSoA<16>, float, Vector3f, Vector3f>;
+ * ```
+ */
+template <std::size_t Lanes = 8, typename Alloc = DefaultAlloc>
+struct AoSoA {
+  static_assert(Lanes > 0, "A tile should hold at least one row");
+
+  template <typename T>
+  using Allocator = typename Alloc::template Allocator<T>;
+};
+
+/**
+ * A non-owning view over a tiled column. Elements are contiguous within each
+ * tile, so inner loops should walk `tile(t)` for every tile `t`.
+ */
+template <typename T, std::size_t Lanes>
+class TiledSpan {
+public:
+  static constexpr std::size_t LANES = Lanes;
+
+  TiledSpan(unsigned char *base, std::size_t tile_bytes, std::size_t length)
+      : base(base), tile_bytes(tile_bytes), length(length) {}
+
+  std::size_t size() const { return this->length; }
+
+  bool empty() const { return this->length == 0; }
+
+  std::size_t num_tiles() const { return (this->length + Lanes - 1) / Lanes; }
+
+  T &operator[](std::size_t i) const {
+    return this->lanes(i / Lanes)[i % Lanes];
+  }
+
+  /**
+   * Get the contiguous view of the column in the `t`th tile. Only the last
+   * tile may hold fewer than `LANES` elements.
+   */
+  Span<T> tile(std::size_t t) const {
+    return Span<T>(this->lanes(t), std::min(Lanes, this->length - t * Lanes));
+  }
+
+  /**
+   * Get the view of the first `count` elements
+   */
+  TiledSpan<T, Lanes> first(std::size_t count) const {
+    return TiledSpan<T, Lanes>(this->base, this->tile_bytes, count);
+  }
+
+private:
+  T *lanes(std::size_t t) const {
+    return reinterpret_cast<T *>(this->base + t * this->tile_bytes);
+  }
+
+  unsigned char *base;
+  std::size_t tile_bytes;
+  std::size_t length;
+};
+
+/**
+ * The tiles shared by all the columns of a tiled group, each `tile_size()`
+ * bytes long and holding `Lanes` rows
+ */
+template <std::size_t Lanes, typename Alloc>
+class TileBuffer {
+public:
+  TileBuffer(std::size_t tile_bytes) : rows(0), tile_bytes(tile_bytes) {}
+
+  unsigned char *data() { return this->tiles.data(); }
+
+  std::size_t size() const { return this->rows; }
+
+  std::size_t tile_size() const { return this->tile_bytes; }
+
+  /**
+   * Add `count` rows, whose elements are constructed by the caller, and
+   * return the first one. The tiles may move, in which case the columns
+   * should be attached again.
+   */
+  std::size_t grow(std::size_t count) {
+    std::size_t first = this->rows;
+    this->rows += count;
+    std::size_t bytes = num_tiles(this->rows) * this->tile_bytes;
+    if (bytes > this->tiles.size()) {
+      this->tiles.resize(bytes);
+    }
+    return first;
+  }
+
+  void reserve(std::size_t n) {
+    this->tiles.reserve(num_tiles(n) * this->tile_bytes);
+  }
+
+  /**
+   * Drop the rows from `n` on, keeping the tiles
+   */
+  void truncate(std::size_t n) { this->rows = std::min(this->rows, n); }
+
+  void shrink_to_fit() {
+    this->tiles.resize(num_tiles(this->rows) * this->tile_bytes);
+    this->tiles.shrink_to_fit();
+  }
+
+  /**
+   * Get the number of rows the tiles can hold without growing
+   */
+  std::size_t capacity() const {
+    return this->tiles.capacity() / this->tile_bytes * Lanes;
+  }
+
+private:
+  static std::size_t num_tiles(std::size_t rows) {
+    return (rows + Lanes - 1) / Lanes;
+  }
+
+  std::vector<unsigned char,
+              typename Alloc::template Allocator<unsigned char>>
+      tiles;
+  std::size_t rows;
+  std::size_t tile_bytes;
+};
+
+/**
+ * A column of a tiled group: the element of row `i` is the `i % Lanes`th of
+ * the lanes at `offset` bytes into the tile of `i`. The column caches the
+ * start of its lanes, so the group attaches it again whenever the tiles
+ * move.
+ */
+template <std::size_t Index, typename T, std::size_t Lanes, typename Alloc>
+class Storage<Index, T, AoSoA<Lanes, Alloc>> {
+public:
+  static_assert(is_bitwise_copyable<T>::value,
+                "Tiled columns should be bitwise copyable");
+  static_assert(alignof(T) <= alignof(std::max_align_t),
+                "Tiled columns should not be over-aligned");
+
+  Storage() : buffer(nullptr), lanes(nullptr), offset(0), tile_bytes(0) {}
+
+  T &get(Entity i) {
+    return *reinterpret_cast<T *>(this->lanes +
+                                  (i / Lanes) * this->tile_bytes +
+                                  (i % Lanes) * sizeof(T));
+  }
+
+  /**
+   * Get the element `i` for reading
+   */
+  const T &peek(Entity i) { return this->get(i); }
+
+  void set(Entity i, const T &elem) { this->get(i) = elem; }
+
+  void set(Entity i, T &&elem) { this->get(i) = std::move(elem); }
+
+  /**
+   * Set the element `i` of a row added by `extend`
+   */
+  template <typename U>
+  void fill(Entity i, U &&elem) {
+    this->get(i) = std::forward<U>(elem);
+  }
+
+  /**
+   * Construct the element of the new row `i` from `args`
+   */
+  template <typename... Args>
+  void construct(Entity i, Args &&... args) {
+    new (&this->get(i)) T(std::forward<Args>(args)...);
+  }
+
+  std::size_t capacity() const { return this->buffer->capacity(); }
+
+  void swap(Entity i, Entity j) { std::swap(this->get(i), this->get(j)); }
+
+  void relocate(Entity from, Entity to) {
+    this->get(to) = std::move(this->get(from));
+  }
+
+  void advise_sequential() {}
+
+  /**
+   * Get the end of the tile containing element `i`
+   */
+  std::size_t contiguous_end(Entity i) const {
+    return (i / Lanes + 1) * Lanes;
+  }
+
+  T *data_at(Entity i, std::size_t count) { return &this->get(i); }
+
+  /**
+   * Get the tiled view of the whole column
+   */
+  TiledSpan<T, Lanes> span() {
+    return TiledSpan<T, Lanes>(this->lanes, this->tile_bytes,
+                               this->buffer->size());
+  }
+
+  /**
+   * Place the lanes of the column at the first offset from `position`
+   * fitting its alignment, and return the offset past them
+   */
+  std::size_t place(std::size_t position) {
+    this->offset = (position + alignof(T) - 1) / alignof(T) * alignof(T);
+    return this->offset + Lanes * sizeof(T);
+  }
+
+  void attach(TileBuffer<Lanes, Alloc> &buffer) {
+    this->buffer = &buffer;
+    this->lanes = buffer.data() + this->offset;
+    this->tile_bytes = buffer.tile_size();
+  }
+
+private:
+  TileBuffer<Lanes, Alloc> *buffer;
+
+  // The lanes of this column in the first tile
+  unsigned char *lanes;
+
+  std::size_t offset;
+  std::size_t tile_bytes;
+};
+
+template <std::size_t Index, std::size_t Lanes, typename Alloc,
+          typename... Types>
+class TiledStorageGroupBase {
+public:
+  std::tuple<> get_bulk(Entity i) { return std::make_tuple(); }
+
+  template <typename Tuple>
+  void set_bulk(Entity i, Tuple &&args) {}
+
+  template <typename Tuple>
+  void fill_bulk(Entity i, Tuple &&args) {}
+
+  template <typename Tuple>
+  void construct_bulk(Entity i, Tuple &&args) {}
+
+  void construct_default(Entity i) {}
+
+  template <typename... Columns>
+  void set_from(Entity i, const std::tuple<Columns...> &columns,
+                std::size_t k) {}
+
+  template <typename... Columns>
+  void construct_from(Entity i, const std::tuple<Columns...> &columns,
+                      std::size_t k) {}
+
+  void column_stats(std::vector<ColumnStats> &columns, std::size_t size) {}
+
+  void swap(Entity i, Entity j) {}
+
+  void relocate(Entity from, Entity to) {}
+
+  std::size_t place(std::size_t position) { return position; }
+
+  std::size_t max_alignment() { return 1; }
+
+  void attach(TileBuffer<Lanes, Alloc> &buffer) {}
+
+  std::size_t contiguous_end(Entity i) {
+    return std::numeric_limits<std::size_t>::max();
+  }
+
+  std::tuple<> data_at(Entity i, std::size_t count) {
+    return std::make_tuple();
+  }
+};
+
+template <std::size_t Index, std::size_t Lanes, typename Alloc, typename T,
+          typename... Types>
+class TiledStorageGroupBase<Index, Lanes, Alloc, T, Types...>
+    : public Storage<Index, T, AoSoA<Lanes, Alloc>>,
+      public TiledStorageGroupBase<Index + 1, Lanes, Alloc, Types...> {
+public:
+  using Column = Storage<Index, T, AoSoA<Lanes, Alloc>>;
+
+  using Next = TiledStorageGroupBase<Index + 1, Lanes, Alloc, Types...>;
+
+  std::tuple<T &, Types &...> get_bulk(Entity i) {
+    return std::tuple_cat(std::tie(Column::get(i)), Next::get_bulk(i));
+  }
+
+  template <typename Tuple>
+  void set_bulk(Entity i, Tuple &&args) {
+    Column::set(i, std::get<Index>(std::forward<Tuple>(args)));
+    Next::set_bulk(i, std::forward<Tuple>(args));
+  }
+
+  template <typename Tuple>
+  void fill_bulk(Entity i, Tuple &&args) {
+    Column::fill(i, std::get<Index>(std::forward<Tuple>(args)));
+    Next::fill_bulk(i, std::forward<Tuple>(args));
+  }
+
+  template <typename Tuple>
+  void construct_bulk(Entity i, Tuple &&args) {
+    Column::construct(i, std::get<Index>(std::forward<Tuple>(args)));
+    Next::construct_bulk(i, std::forward<Tuple>(args));
+  }
+
+  void construct_default(Entity i) {
+    Column::construct(i);
+    Next::construct_default(i);
+  }
+
+  template <typename... Columns>
+  void set_from(Entity i, const std::tuple<Columns...> &columns,
+                std::size_t k) {
+    Column::set(i, std::get<Index>(columns)[k]);
+    Next::set_from(i, columns, k);
+  }
+
+  template <typename... Columns>
+  void construct_from(Entity i, const std::tuple<Columns...> &columns,
+                      std::size_t k) {
+    Column::construct(i, std::get<Index>(columns)[k]);
+    Next::construct_from(i, columns, k);
+  }
+
+  void column_stats(std::vector<ColumnStats> &columns, std::size_t size) {
+    columns.push_back({size * sizeof(T), Column::capacity() * sizeof(T)});
+    Next::column_stats(columns, size);
+  }
+
+  void swap(Entity i, Entity j) {
+    Column::swap(i, j);
+    Next::swap(i, j);
+  }
+
+  void relocate(Entity from, Entity to) {
+    Column::relocate(from, to);
+    Next::relocate(from, to);
+  }
+
+  /**
+   * Lay out the columns in a tile from `position` on, in order, and return
+   * the end of the last one
+   */
+  std::size_t place(std::size_t position) {
+    return Next::place(Column::place(position));
+  }
+
+  std::size_t max_alignment() {
+    return std::max(alignof(T), Next::max_alignment());
+  }
+
+  void attach(TileBuffer<Lanes, Alloc> &buffer) {
+    Column::attach(buffer);
+    Next::attach(buffer);
+  }
+
+  std::size_t contiguous_end(Entity i) { return Column::contiguous_end(i); }
+
+  auto data_at(Entity i, std::size_t count) {
+    return std::tuple_cat(std::make_tuple(Column::data_at(i, count)),
+                          Next::data_at(i, count));
+  }
+};
+
+/**
+ * A group of columns laid out in tiles of `Lanes` rows (see `AoSoA`), with
+ * the same interface as the column-per-vector group
+ */
+template <std::size_t Lanes, typename Alloc, typename T, typename... Types>
+struct BasicStorageGroup<AoSoA<Lanes, Alloc>, T, Types...>
+    : TiledStorageGroupBase<0, Lanes, Alloc, T, Types...> {
+  using Base = TiledStorageGroupBase<0, Lanes, Alloc, T, Types...>;
+
+  BasicStorageGroup() : buffer(this->layout()) { Base::attach(this->buffer); }
+
+  BasicStorageGroup(const BasicStorageGroup &other)
+      : Base(other), buffer(other.buffer) {
+    Base::attach(this->buffer);
+  }
+
+  BasicStorageGroup(BasicStorageGroup &&other)
+      : Base(other), buffer(std::move(other.buffer)) {
+    Base::attach(this->buffer);
+    other.Base::attach(other.buffer);
+  }
+
+  BasicStorageGroup &operator=(const BasicStorageGroup &other) {
+    this->buffer = other.buffer;
+    Base::attach(this->buffer);
+    return *this;
+  }
+
+  BasicStorageGroup &operator=(BasicStorageGroup &&other) {
+    this->buffer = std::move(other.buffer);
+    Base::attach(this->buffer);
+    other.Base::attach(other.buffer);
+    return *this;
+  }
+
+  /**
+   * Append a row constructed from the elements of `args`, forwarded the same
+   * way as in `set_bulk`
+   */
+  template <typename Tuple>
+  void push_bulk(Tuple &&args) {
+    std::size_t i = this->grow(1);
+    Base::construct_bulk(i, std::forward<Tuple>(args));
+  }
+
+  /**
+   * Append the elements `[offset, offset + count)` of the matching span in
+   * `columns` as new rows
+   */
+  template <typename... Columns>
+  void push_many(const std::tuple<Columns...> &columns, std::size_t offset,
+                 std::size_t count) {
+    std::size_t first = this->grow(count);
+    for (std::size_t k = 0; k < count; k++) {
+      Base::construct_from(first + k, columns, offset + k);
+    }
+  }
+
+  /**
+   * Append `count` rows of value-initialized elements
+   */
+  void extend(std::size_t count) {
+    std::size_t first = this->grow(count);
+    for (std::size_t k = 0; k < count; k++) {
+      Base::construct_default(first + k);
+    }
+  }
+
+  void reserve(std::size_t n) {
+    this->buffer.reserve(n);
+    Base::attach(this->buffer);
+  }
+
+  void truncate(std::size_t n) { this->buffer.truncate(n); }
+
+  void shrink_to_fit() {
+    this->buffer.shrink_to_fit();
+    Base::attach(this->buffer);
+  }
+
+  void advise_sequential() {}
+
+private:
+  /**
+   * Lay out the columns in a tile, and return the size of a tile, padded so
+   * that every tile is aligned like the first
+   */
+  std::size_t layout() {
+    std::size_t alignment = Base::max_alignment();
+    std::size_t end = Base::place(0);
+    return (end + alignment - 1) / alignment * alignment;
+  }
+
+  std::size_t grow(std::size_t count) {
+    std::size_t first = this->buffer.grow(count);
+    Base::attach(this->buffer);
+    return first;
+  }
+
+  TileBuffer<Lanes, Alloc> buffer;
+};
+
+#endif
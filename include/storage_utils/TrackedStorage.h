@@ -0,0 +1,251 @@
+#include "StorageGroup.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#ifndef TRACKED_STORAGE_H
+#define TRACKED_STORAGE_H
+
+/**
+ * The column backend tracking the changes of the `Column` column (a
+ * component type, or another backend such as `Paged<T>`). Every row carries
+ * the version of its last write, so that incremental consumers only visit
+ * the rows changed since the version they last saw, using
+ * `for_each_changed`. Writes are `update`, `update_component`, insertion,
+ * and any mutable access to the component such as iterating the storage
+ * group. Writes through a `column()` span are not tracked. Rows may be
+ * written from several threads at once (e.g. in `par_for_each`), as long as
+ * every row is written by one thread only.
+ *
+ * Sample usage:
+ *
+ * ``` c++
+ * VecStorageGroup<float, Tracked<Vector3f>> particles;
+ * std::uint64_t seen = particles.advance_version<1>();
+ * // ... update some positions ...
+ * particles.for_each_changed<1>(seen, [](Entity i, const Vector3f &x) {
+ *   // Upload `x`
+ * });
+ * ```
+ */
+template <typename Column>
+struct Tracked {};
+
+template <typename Column>
+struct column_type<Tracked<Column>> {
+  using Type = ComponentType<Column>;
+};
+
+template <std::size_t Index, typename Column, typename Alloc>
+class Storage<Index, Tracked<Column>, Alloc> {
+public:
+  using T = ComponentType<Column>;
+
+  // The number of rows summarized by one block version
+  static constexpr std::size_t BLOCK_SIZE = 64;
+
+  Storage() : clock(1) {}
+
+  /**
+   * Get the element `i` for writing, which counts as a write
+   */
+  T &get(Entity i) {
+    this->mark(i);
+    return this->inner.get(i);
+  }
+
+  /**
+   * Get the element `i` for reading, which is not tracked
+   */
+  const T &peek(Entity i) { return this->inner.get(i); }
+
+  void set(Entity i, const T &elem) {
+    this->mark(i);
+    this->inner.set(i, elem);
+  }
+
+  void set(Entity i, T &&elem) {
+    this->mark(i);
+    this->inner.set(i, std::move(elem));
+  }
+
+  /**
+   * Set the element `i` of a row added by `extend`, without marking it: the
+   * row was stamped by `extend` already, and rows filled by different threads
+   * may share a block
+   */
+  template <typename U>
+  void fill(Entity i, U &&elem) {
+    this->inner.fill(i, std::forward<U>(elem));
+  }
+
+  void push(const T &elem) {
+    this->inner.push(elem);
+    this->grow(1);
+  }
+
+  void push(T &&elem) {
+    this->inner.push(std::move(elem));
+    this->grow(1);
+  }
+
+  template <typename... Args>
+  void emplace(Args &&... args) {
+    this->inner.emplace(std::forward<Args>(args)...);
+    this->grow(1);
+  }
+
+  void push_many(const T *elems, std::size_t count) {
+    this->inner.push_many(elems, count);
+    this->grow(count);
+  }
+
+  void extend(std::size_t count) {
+    this->inner.extend(count);
+    this->grow(count);
+  }
+
+  void reserve(std::size_t n) {
+    this->inner.reserve(n);
+    this->versions.reserve(n);
+  }
+
+  std::size_t capacity() const { return this->inner.capacity(); }
+
+  void swap(Entity i, Entity j) {
+    this->mark(i);
+    this->mark(j);
+    this->inner.swap(i, j);
+  }
+
+  void relocate(Entity from, Entity to) {
+    this->mark(to);
+    this->inner.relocate(from, to);
+  }
+
+  void truncate(std::size_t n) {
+    this->inner.truncate(n);
+    n = std::min(n, this->versions.size());
+    this->versions.resize(n);
+    this->blocks.resize((n + BLOCK_SIZE - 1) / BLOCK_SIZE);
+  }
+
+  void shrink_to_fit() {
+    this->inner.shrink_to_fit();
+    this->versions.shrink_to_fit();
+    this->blocks.shrink_to_fit();
+  }
+
+  void advise_sequential() { this->inner.advise_sequential(); }
+
+  std::size_t contiguous_end(Entity i) const {
+    return this->inner.contiguous_end(i);
+  }
+
+  /**
+   * Get the pointer to the `count` elements from `i` on for writing, which
+   * counts as a write of all of them
+   */
+  T *data_at(Entity i, std::size_t count) {
+    std::fill(this->versions.begin() + i, this->versions.begin() + i + count,
+              this->clock);
+    for (std::size_t b = i / BLOCK_SIZE;
+         b < (i + count + BLOCK_SIZE - 1) / BLOCK_SIZE; b++) {
+      this->blocks[b].stamp(this->clock);
+    }
+    return this->inner.data_at(i, count);
+  }
+
+  auto span() { return this->inner.span(); }
+
+  /**
+   * Get the current version, which stamps the rows written from now on
+   */
+  std::uint64_t version() const { return this->clock; }
+
+  /**
+   * Start a new version, and return the one that was current. The rows
+   * written from now on are changed since the returned version.
+   */
+  std::uint64_t advance_version() { return this->clock++; }
+
+  /**
+   * Find the first row at `i` or after that changed since version `since`,
+   * skipping a block of `BLOCK_SIZE` clean rows at a time. Return the number
+   * of rows if there's none.
+   */
+  std::size_t find_changed(std::size_t i, std::uint64_t since) {
+    std::size_t size = this->versions.size();
+    while (i < size) {
+      if (this->blocks[i / BLOCK_SIZE].load() <= since) {
+        i = (i / BLOCK_SIZE + 1) * BLOCK_SIZE;
+      } else if (this->versions[i] <= since) {
+        i++;
+      } else {
+        return i;
+      }
+    }
+    return size;
+  }
+
+private:
+  /**
+   * The latest version of a block, shared by the threads writing its rows.
+   * It is only stored when it changes, with a relaxed atomic store, since
+   * the versions are only read once the writers are done. Copies load the
+   * version, so that the blocks can be held in a `std::vector`.
+   */
+  class BlockVersion {
+  public:
+    BlockVersion() : version(0) {}
+
+    BlockVersion(const BlockVersion &other) : version(other.load()) {}
+
+    BlockVersion &operator=(const BlockVersion &other) {
+      this->version.store(other.load(), std::memory_order_relaxed);
+      return *this;
+    }
+
+    std::uint64_t load() const {
+      return this->version.load(std::memory_order_relaxed);
+    }
+
+    void stamp(std::uint64_t clock) {
+      if (this->load() != clock) {
+        this->version.store(clock, std::memory_order_relaxed);
+      }
+    }
+
+  private:
+    std::atomic<std::uint64_t> version;
+  };
+
+  void mark(Entity i) {
+    this->versions[i] = this->clock;
+    this->blocks[i / BLOCK_SIZE].stamp(this->clock);
+  }
+
+  void grow(std::size_t count) {
+    std::size_t size = this->versions.size() + count;
+    this->versions.resize(size, this->clock);
+    this->blocks.resize((size + BLOCK_SIZE - 1) / BLOCK_SIZE);
+    for (std::size_t b = (size - count) / BLOCK_SIZE; b < this->blocks.size();
+         b++) {
+      this->blocks[b].stamp(this->clock);
+    }
+  }
+
+  Storage<Index, Column, Alloc> inner;
+
+  // The version of the last write of every row
+  std::vector<std::uint64_t> versions;
+
+  // The latest version of every block of `BLOCK_SIZE` rows
+  std::vector<BlockVersion> blocks;
+
+  std::uint64_t clock;
+};
+
+#endif
@@ -1,65 +1,130 @@
+#include "BitSet.h"
+#include "CommandBuffer.h"
+#include "ConcurrentAppender.h"
 #include "JoinedStorageGroup.h"
+#include "OwningGroup.h"
+#include "ReusePolicy.h"
+#include "Snapshot.h"
 #include "StorageGroup.h"
-#include <unordered_set>
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <optional>
 
 #ifndef VEC_STORAGE_GROUP_H
 #define VEC_STORAGE_GROUP_H
 
-template <typename... Types>
+template <typename Group, typename... Types>
 class VecStorageGroupIterator {
 public:
-  VecStorageGroupIterator(
-      const std::size_t &max_size,
-      const std::unordered_set<std::size_t> &removed_indices,
-      StorageGroup<Types...> &storage_group, std::size_t index)
-      : max_size(max_size), removed_indices(removed_indices),
-        storage_group(storage_group), index(index) {}
-
-  std::tuple<std::size_t, Types &...> operator*() {
+  VecStorageGroupIterator(const BitSet &alive, Group &storage_group,
+                          std::size_t index)
+      : alive(alive), storage_group(storage_group), index(index) {}
+
+  std::tuple<std::size_t, ComponentType<Types> &...> operator*() {
     return std::tuple_cat(std::tie(this->index),
                           this->storage_group.get_bulk(this->index));
   }
 
-  void operator++() {
-    this->index++;
-    auto end = this->removed_indices.end();
-    while (this->removed_indices.find(this->index) != end) {
-      this->index++;
-      if (this->index >= this->max_size) {
-        break;
-      }
-    }
+  void operator++() { this->index = this->alive.find_next(this->index + 1); }
+
+  bool operator!=(VecStorageGroupIterator<Group, Types...> other) {
+    return this->index != other.index;
+  }
+
+private:
+  std::size_t index;
+
+  const BitSet &alive;
+  Group &storage_group;
+};
+
+template <class VS, std::size_t... Is>
+class VecStorageViewIterator {
+public:
+  VecStorageViewIterator(VS &vs, std::size_t index) : vs(vs), index(index) {}
+
+  std::tuple<Entity, typename VS::template TypeAt<Is> &...> operator*() {
+    return {this->index,
+            this->vs.template get_component_unchecked<Is>(this->index)...};
   }
 
-  bool operator!=(VecStorageGroupIterator<Types...> other) {
+  void operator++() { this->index = this->vs.find_next(this->index + 1); }
+
+  bool operator!=(VecStorageViewIterator<VS, Is...> other) {
     return this->index != other.index;
   }
 
 private:
+  VS &vs;
   std::size_t index;
+};
+
+/**
+ * The entities assigned to the elements of a batch by `insert_many`, in the
+ * order of the batch. The first `reused.size()` elements filled removed
+ * slots, and the rest were appended as the range `[appended_begin,
+ * appended_end)`.
+ */
+struct EntityRange {
+  std::vector<Entity> reused;
+  Entity appended_begin;
+  Entity appended_end;
 
-  const std::size_t &max_size;
-  const std::unordered_set<std::size_t> &removed_indices;
-  StorageGroup<Types...> &storage_group;
+  std::size_t size() const {
+    return this->reused.size() + this->appended_end - this->appended_begin;
+  }
+
+  /**
+   * Get the entity assigned to the `k`th element of the batch
+   */
+  Entity operator[](std::size_t k) const {
+    if (k < this->reused.size()) {
+      return this->reused[k];
+    }
+    return this->appended_begin + (k - this->reused.size());
+  }
 };
 
-template <typename... Types>
-class VecStorageGroup {
+/**
+ * A group of storages sharing the same indices. The `Reuse` policy decides
+ * which removed slot gets filled by `insert` (see `ReusePolicy.h`), and the
+ * `Alloc` policy how the columns are allocated (see `Allocator.h`).
+ */
+template <typename Reuse, typename Alloc, typename... Types>
+class BasicVecStorageGroup {
 public:
-  // The helper type `TypeAt<Index>`
+  // The helper type `ColumnAt<Index>` for the declared type of a column
+  template <std::size_t Index>
+  using ColumnAt = typename extract_type_at<Index, Types...>::Type;
+
+  // The helper type `TypeAt<Index>` for the component type of a column
   template <std::size_t Index>
-  using TypeAt = typename extract_type_at<Index, Types...>::Type;
+  using TypeAt = ComponentType<ColumnAt<Index>>;
 
   // The helper type `Bulk` for the tuple of all types
-  using Bulk = std::tuple<Types...>;
+  using Bulk = std::tuple<ComponentType<Types>...>;
 
   // The helper type `BulkRef` for the tuple containing reference to all types
-  using BulkRef = std::tuple<Types &...>;
+  using BulkRef = std::tuple<ComponentType<Types> &...>;
+
+  // The helper type `Group` for the underlying storage group
+  using Group = BasicStorageGroup<Alloc, Types...>;
+
+  // The helper type `StorageAt<Index>` for the column storing `TypeAt<Index>`
+  template <std::size_t Index>
+  using StorageAt = Storage<Index, ColumnAt<Index>, Alloc>;
+
+  // The helper type `Iterator`
+  using Iterator = VecStorageGroupIterator<Group, Types...>;
 
   /**
    * Default constructor
    */
-  VecStorageGroup() : storage_group(), max_size(0), first_index(0) {}
+  BasicVecStorageGroup()
+      : first_index(0), max_size(0), num_removed(0), storage_group() {}
 
   /**
    * Get an optional Bulk of data from the storage at index `i`;
@@ -80,9 +145,8 @@ public:
    * Insert all the data (as function arguments) to the storage group.
    * Will return the index where the item get insert to.
    */
-  Entity insert(Types... args) {
-    auto data = std::make_tuple(args...);
-    return this->insert_bulk(data);
+  Entity insert(ComponentType<Types>... args) {
+    return this->emplace_bulk(std::forward_as_tuple(std::move(args)...));
   }
 
   /**
@@ -90,16 +154,47 @@ public:
    * Will fill in the empty slots within the storage when available.
    * Will return the index where the item get insert to.
    */
-  Entity insert_bulk(Bulk data) {
+  Entity insert_bulk(Bulk data) { return this->emplace_bulk(std::move(data)); }
+
+  /**
+   * Insert an element whose components are constructed from `args`, one
+   * argument per component. The arguments are forwarded straight into the
+   * columns: an appended component is constructed in place, and a component
+   * filling a removed slot is assigned from its argument, so an rvalue
+   * argument is moved and never copied.
+   *
+   * Sample usage:
+   *
+   * ``` c++
+   * VecStorageGroup<float, std::vector<int>> storage;
+   * std::vector<int> neighbors = {1, 2, 3};
+   * Entity i = storage.emplace(1.0, std::move(neighbors));
+   * ```
+   */
+  template <typename... Args>
+  Entity emplace(Args &&... args) {
+    static_assert(sizeof...(Args) == sizeof...(Types),
+                  "There should be one argument per component");
+    return this->emplace_bulk(
+        std::forward_as_tuple(std::forward<Args>(args)...));
+  }
+
+  /**
+   * Same as `emplace`, with the arguments given as a tuple, e.g. a `Bulk` or
+   * the result of `std::forward_as_tuple`
+   */
+  template <typename Tuple>
+  Entity emplace_bulk(Tuple &&args) {
     Entity index;
-    if (this->removed_indices.empty()) {
+    if (this->reuse.empty()) {
       index = this->max_size++;
-      this->storage_group.push_bulk(data);
+      this->storage_group.push_bulk(std::forward<Tuple>(args));
+      this->alive.push(true);
     } else {
-      auto first_index_it = this->removed_indices.begin();
-      index = *first_index_it;
-      this->removed_indices.erase(first_index_it);
-      this->storage_group.set_bulk(index, data);
+      index = this->reuse.pop();
+      this->num_removed--;
+      this->storage_group.set_bulk(index, std::forward<Tuple>(args));
+      this->alive.set(index);
     }
     if (index < this->first_index) {
       this->first_index = index;
@@ -107,33 +202,124 @@ public:
     return index;
   }
 
+  /**
+   * Reserve the columns for `n` slots in total, so that inserting up to that
+   * many elements will not reallocate
+   */
+  void reserve(std::size_t n) {
+    this->storage_group.reserve(n);
+    this->alive.reserve(n);
+  }
+
+  /**
+   * Insert a batch of elements given as one span per component; all the
+   * spans should have the same size. The removed slots are filled first
+   * (in the order of the reuse policy), then the rest of the batch is
+   * appended to each column as one block. Return the entities assigned to
+   * the batch.
+   *
+   * Sample usage:
+   *
+   * ``` c++
+   * VecStorageGroup<float, int> storage;
+   * std::vector<float> masses = {1.0, 2.0, 3.0};
+   * std::vector<int> charges = {1, -1, 0};
+   * EntityRange ids = storage.insert_many(masses, charges);
+   * ```
+   */
+  EntityRange insert_many(Span<const ComponentType<Types>>... columns) {
+    auto spans = std::make_tuple(columns...);
+    std::size_t n = std::get<0>(spans).size();
+
+    // Fill the removed slots
+    EntityRange range;
+    while (range.reused.size() < n && !this->reuse.empty()) {
+      Entity index = this->reuse.pop();
+      this->storage_group.set_from(index, spans, range.reused.size());
+      this->alive.set(index);
+      this->first_index = std::min(this->first_index, index);
+      range.reused.push_back(index);
+    }
+    this->num_removed -= range.reused.size();
+
+    // Append the rest as a block
+    std::size_t count = n - range.reused.size();
+    range.appended_begin = this->max_size;
+    range.appended_end = this->max_size + count;
+    this->storage_group.push_many(spans, range.reused.size(), count);
+    this->alive.resize(range.appended_end, true);
+    this->max_size = range.appended_end;
+    return range;
+  }
+
+  /**
+   * Start appending up to `capacity` elements from several threads at once,
+   * without locks: every column is extended by `capacity` value-initialized
+   * slots, which the threads claim and write through the returned
+   * `ConcurrentAppender`. The elements become valid on its `commit`.
+   *
+   * Sample usage:
+   *
+   * ``` c++
+   * auto appender = particles.append_concurrently(1000);
+   * pool.run(4, [&](std::size_t) {
+   *   while (appender.append(1.0, random_point(), Vector2f(0, 0))) {
+   *   }
+   * });
+   * appender.commit(); // 1000 particles appended
+   * ```
+   */
+  ConcurrentAppender<BasicVecStorageGroup<Reuse, Alloc, Types...>>
+  append_concurrently(std::size_t capacity) {
+    this->storage_group.extend(capacity);
+    return ConcurrentAppender<BasicVecStorageGroup<Reuse, Alloc, Types...>>(
+        *this, this->max_size, capacity);
+  }
+
+  /**
+   * Write the slot `i` extended by `append_concurrently`, before it is
+   * committed. Called by `ConcurrentAppender::set`, from any thread.
+   */
+  template <typename Tuple>
+  void fill_appended(Entity i, Tuple &&args) {
+    this->storage_group.fill_bulk(i, std::forward<Tuple>(args));
+  }
+
+  /**
+   * Make the first `count` slots extended by `append_concurrently` valid,
+   * and drop the others. Called by `ConcurrentAppender::commit`.
+   */
+  void commit_appended(std::size_t count) {
+    std::size_t end = this->max_size + count;
+    this->storage_group.truncate(end);
+    this->alive.resize(end, true);
+    if (count > 0) {
+      this->first_index = std::min(this->first_index, this->max_size);
+    }
+    this->max_size = end;
+  }
+
   /**
    * Force append the data as function arguments to the end of the storage.
    * Return the inserted index.
    */
-  Entity append(Types... args) {
-    auto data = std::make_tuple(args...);
-    return this->append_bulk(data);
+  Entity append(ComponentType<Types>... args) {
+    return this->append_from(std::forward_as_tuple(std::move(args)...));
   }
 
   /**
    * Force append the data as bulk to the end of the storage. Return the
    * inserted index.
    */
-  Entity append_bulk(Bulk data) {
-    Entity index = this->max_size++;
-    this->storage_group.push_bulk(data);
-    return index;
-  }
+  Entity append_bulk(Bulk data) { return this->append_from(std::move(data)); }
 
   /**
    * Update all the data (provided as function arguments) at position `i`
    * Will return `true` if update is successful (index is valid)
    * Will return `false` when index is not valid
    */
-  bool update(Entity i, Types... args) {
-    auto data = std::make_tuple(args...);
-    return this->update_bulk(i, data);
+  bool update(Entity i, ComponentType<Types>... args) {
+    return this->update_from(i, std::forward_as_tuple(std::move(args)...));
   }
 
   /**
@@ -142,11 +328,7 @@ public:
    * Will return `false` when index is not valid
    */
   bool update_bulk(Entity i, Bulk data) {
-    if (this->is_valid(i)) {
-      this->storage_group.set_bulk(i, data);
-      return false;
-    }
-    return true;
+    return this->update_from(i, std::move(data));
   }
 
   /**
@@ -155,17 +337,13 @@ public:
    */
   bool remove(Entity i) {
     if (this->is_valid(i)) {
-      this->removed_indices.insert(i);
+      this->alive.reset(i);
+      this->reuse.push(i);
+      this->num_removed++;
 
       // Update the first_index
       if (i == this->first_index) {
-        auto end = this->removed_indices.end();
-        for (int j = i + 1; j < this->max_size; j++) {
-          if (this->removed_indices.find(j) == end) {
-            this->first_index = j;
-            break;
-          }
-        }
+        this->first_index = this->alive.find_next(i + 1);
       }
 
       // Return true since we successfully removed an element
@@ -174,6 +352,96 @@ public:
     return false;
   }
 
+  /**
+   * Remove a batch of entities in one pass: the batch is sorted, the
+   * liveness bits are cleared a word at a time, the removed slots are handed
+   * to the reuse policy from the highest down (so that a LIFO policy refills
+   * the lowest first), and the first valid index is updated once. Invalid
+   * and duplicate entities are skipped. Return the number of elements
+   * removed.
+   */
+  std::size_t remove_many(std::vector<Entity> entities) {
+    std::sort(entities.begin(), entities.end(), std::greater<Entity>());
+    std::size_t k = 0, count = 0;
+    while (k < entities.size() && entities[k] >= this->max_size) {
+      k++;
+    }
+    while (k < entities.size()) {
+      // Gather the batch entities falling in one word of the liveness mask
+      std::size_t word_index = entities[k] / BitSet::WORD_BITS;
+      BitSet::Word mask = 0;
+      for (; k < entities.size() &&
+             entities[k] / BitSet::WORD_BITS == word_index;
+           k++) {
+        mask |= BitSet::Word(1) << (entities[k] % BitSet::WORD_BITS);
+      }
+      mask &= this->alive.words_span()[word_index];
+      this->alive.reset_mask(word_index, mask);
+
+      // Free the slots from the highest down
+      for (; mask != 0; count++) {
+        std::size_t bit = BitSet::WORD_BITS - 1 - count_leading_zeros(mask);
+        this->reuse.push(word_index * BitSet::WORD_BITS + bit);
+        mask &= ~(BitSet::Word(1) << bit);
+      }
+    }
+    this->num_removed += count;
+    this->first_index = this->alive.find_next(this->first_index);
+    return count;
+  }
+
+  /**
+   * Pack all the valid elements to the front of the storage, drop the dead
+   * slots at the end and shrink the columns. Valid elements are moved from
+   * the back into the lowest holes, so their entities change; the moves are
+   * applied to every dense storage in `dss` (see
+   * `DenseStorageGroup::remap`) and returned, so that other tables keyed on
+   * the entities can follow.
+   *
+   * Sample usage:
+   *
+   * ``` c++
+   * EntityRemap moves = particles.compact(hardenings, deformations);
+   * ```
+   */
+  template <typename... DSS>
+  EntityRemap compact(DSS &... dss) {
+    EntityRemap moves = this->compact_incremental(
+        std::numeric_limits<std::size_t>::max(), dss...);
+    this->storage_group.shrink_to_fit();
+    return moves;
+  }
+
+  /**
+   * Same as `compact`, but move at most `max_moves` elements, so that the
+   * work can be spread across frames. The dead slots at the end are still
+   * dropped, but the capacity of the columns is kept.
+   */
+  template <typename... DSS>
+  EntityRemap compact_incremental(std::size_t max_moves, DSS &... dss) {
+    std::size_t size = this->size();
+    EntityRemap moves;
+    this->truncate_dead_tail();
+    for (Entity to = this->alive.find_next_unset(0);
+         moves.size() < max_moves && to < this->max_size;
+         to = this->alive.find_next_unset(to + 1)) {
+      // The last slot is valid after the dead tail is truncated
+      Entity from = this->max_size - 1;
+      this->storage_group.relocate(from, to);
+      this->alive.set(to);
+      this->alive.reset(from);
+      moves.push_back({from, to});
+      this->truncate_dead_tail();
+    }
+
+    this->num_removed = this->max_size - size;
+    this->first_index = this->alive.find_next(0);
+    this->refill_reuse();
+
+    (dss.remap(moves), ...);
+    return moves;
+  }
+
   /**
    * Get an optional specific component at index `i`.
    * If there's no such element at index `i`, then return `None`.
@@ -188,8 +456,8 @@ public:
   template <std::size_t Index>
   std::optional<TypeAt<Index>> get_component(Entity i) {
     if (this->is_valid(i)) {
-      using S = Storage<Index, TypeAt<Index>>;
-      return (static_cast<S &>(this->storage_group)).get(i);
+      using S = StorageAt<Index>;
+      return (static_cast<S &>(this->storage_group)).peek(i);
     } else {
       return {};
     }
@@ -197,7 +465,7 @@ public:
 
   template <std::size_t Index>
   TypeAt<Index> &get_component_unchecked(Entity i) {
-    using S = Storage<Index, TypeAt<Index>>;
+    using S = StorageAt<Index>;
     return (static_cast<S &>(this->storage_group)).get(i);
   }
 
@@ -215,16 +483,20 @@ public:
    */
   template <std::size_t Index>
   bool update_component(Entity i, TypeAt<Index> elem) {
-    using S = Storage<Index, TypeAt<Index>>;
+    using S = StorageAt<Index>;
     if (this->is_valid(i)) {
-      (static_cast<S &>(this->storage_group)).set(i, elem);
+      (static_cast<S &>(this->storage_group)).set(i, std::move(elem));
       return true;
     }
     return false;
   }
 
   /**
-   * Extract all the valid data (as a `std::vector`)of a given component.
+   * Extract all the valid data (as a `std::vector`)of a given component. The
+   * output is allocated once, and the valid slots are gathered a liveness
+   * word at a time: runs of fully valid words are copied as one block (a
+   * single `memcpy` for a packed storage of trivially copyable components),
+   * and the slots of the other words are picked bit by bit.
    *
    * Sample Usage:
    *
@@ -236,27 +508,146 @@ public:
   template <std::size_t Index>
   std::vector<TypeAt<Index>> extract() {
     std::vector<TypeAt<Index>> result;
-    auto removed_index_end = this->removed_indices.end();
-    for (std::size_t i = 0; i < this->max_size; i++) {
-      if (this->removed_indices.find(i) == removed_index_end) {
-        result.push_back(this->get_component<Index>(i).value());
+    result.reserve(this->size());
+    this->extract_columns<Index>(std::tie(result), std::index_sequence<0>());
+    return result;
+  }
+
+  /**
+   * Extract several components in one pass over the valid slots, as a tuple
+   * of one `std::vector` per component
+   *
+   * Sample Usage:
+   *
+   * ``` c++
+   * auto [masses, positions] = particles.extract<0, 1>();
+   * ```
+   */
+  template <std::size_t I0, std::size_t I1, std::size_t... Is>
+  std::tuple<std::vector<TypeAt<I0>>, std::vector<TypeAt<I1>>,
+             std::vector<TypeAt<Is>>...>
+  extract() {
+    std::tuple<std::vector<TypeAt<I0>>, std::vector<TypeAt<I1>>,
+               std::vector<TypeAt<Is>>...>
+        result;
+    std::apply(
+        [&](auto &... columns) {
+          (columns.reserve(this->size()), ...);
+          this->extract_columns<I0, I1, Is...>(
+              std::tie(columns...),
+              std::make_index_sequence<sizeof...(Is) + 2>());
+        },
+        result);
+    return result;
+  }
+
+  /**
+   * Same as `extract<Index>()`, writing into the caller-owned buffer `out`.
+   * A buffer shorter than `size()` gets the first `out.size()` elements.
+   * Return the number of elements written.
+   */
+  template <std::size_t Index>
+  std::size_t extract_into(Span<TypeAt<Index>> out) {
+    using S = StorageAt<Index>;
+    auto column = static_cast<S &>(this->storage_group).span();
+    TypeAt<Index> *dest = out.data();
+    TypeAt<Index> *dest_end = out.data() + out.size();
+    this->for_each_valid(
+        [&](std::size_t begin, std::size_t end) {
+          this->copy_column<Index>(
+              begin, end, [&](const TypeAt<Index> *elems, std::size_t count) {
+                count = std::min(count, std::size_t(dest_end - dest));
+                dest = std::copy(elems, elems + count, dest);
+              });
+        },
+        [&](std::size_t i) {
+          if (dest != dest_end) {
+            *dest++ = column[i];
+          }
+        });
+    return dest - out.data();
+  }
+
+  /**
+   * Get the contiguous view of the component column `Index`, covering all
+   * the `_max_size()` slots including the removed ones. Use it together with
+   * `liveness()` to tell the valid slots apart. A `Paged` column is viewed as
+   * a `PagedSpan` instead.
+   *
+   * Sample usage:
+   *
+   * ``` c++
+   * VecStorageGroup<float, float> storage;
+   * auto x = storage.column<0>();
+   * auto v = storage.column<1>();
+   * for (std::size_t i = 0; i < x.size(); i++) {
+   *   x[i] += v[i]; // Removed slots get updated as well, harmlessly
+   * }
+   * ```
+   */
+  template <std::size_t Index>
+  auto column() {
+    using S = StorageAt<Index>;
+    return (static_cast<S &>(this->storage_group)).span();
+  }
+
+  /**
+   * Get the liveness mask matching the columns: slot `i` is valid if bit
+   * `i % 64` of word `i / 64` is set. Bits past `_max_size()` are zero.
+   */
+  Span<const BitSet::Word> liveness() { return this->alive.words_span(); }
+
+  /**
+   * Start a new version of the `Tracked` column `Index`, and return the one
+   * that was current; see `for_each_changed`
+   */
+  template <std::size_t Index>
+  std::uint64_t advance_version() {
+    using S = StorageAt<Index>;
+    return static_cast<S &>(this->storage_group).advance_version();
+  }
+
+  /**
+   * Call `fn(entity, component)` on every valid element whose `Tracked`
+   * column `Index` was written after version `since`, in entity order.
+   * Reading the component in `fn` does not count as a write.
+   */
+  template <std::size_t Index, typename F>
+  void for_each_changed(std::uint64_t since, F fn) {
+    using S = StorageAt<Index>;
+    S &storage = static_cast<S &>(this->storage_group);
+    for (std::size_t i = storage.find_changed(0, since); i < this->max_size;
+         i = storage.find_changed(i + 1, since)) {
+      if (this->alive.test(i)) {
+        fn(i, storage.peek(i));
       }
     }
-    return result;
   }
 
   bool contains(Entity i) { return this->is_valid(i); }
 
+  /**
+   * Get the first valid index at `i` or after. Return `_max_size()` if there
+   * is no valid index left.
+   */
+  Entity find_next(Entity i) { return this->alive.find_next(i); }
+
   /**
    * Get the size of this storage. Only valid elements will be considered.
    */
-  std::size_t size() { return this->max_size - this->removed_indices.size(); }
+  std::size_t size() { return this->max_size - this->num_removed; }
 
   /**
    * [Experimental] Get the maximum size of this storage
    */
   std::size_t _max_size() { return this->max_size; }
 
+  /**
+   * Check if the next insert will refill a removed slot instead of
+   * appending one
+   */
+  bool has_free_slot() { return !this->reuse.empty(); }
+
   /**
    * Check if the storage is empty (basically if size is 0)
    */
@@ -265,36 +656,370 @@ public:
   /**
    * Iterator begin
    */
-  VecStorageGroupIterator<Types...> begin() {
-    return VecStorageGroupIterator(this->max_size, this->removed_indices,
-                                   this->storage_group, this->first_index);
+  Iterator begin() {
+    this->storage_group.advise_sequential();
+    return Iterator(this->alive, this->storage_group, this->first_index);
   }
 
   /**
    * Iterator end
    */
-  VecStorageGroupIterator<Types...> end() {
-    return VecStorageGroupIterator(this->max_size, this->removed_indices,
-                                   this->storage_group, this->max_size);
+  Iterator end() {
+    return Iterator(this->alive, this->storage_group, this->max_size);
+  }
+
+  /**
+   * Get a view iterating the valid elements as `(index, components...)`
+   * with only the component columns `Is...`, so that a loop over a few
+   * columns of a wide storage only streams those columns.
+   *
+   * Sample usage:
+   *
+   * ``` c++
+   * for (auto [i, x, v] : particles.view<1, 2>()) {
+   *   x += v * dt;
+   * }
+   * ```
+   */
+  template <std::size_t... Is>
+  View<VecStorageViewIterator<BasicVecStorageGroup<Reuse, Alloc, Types...>,
+                              Is...>>
+  view() {
+    using ViewIterator =
+        VecStorageViewIterator<BasicVecStorageGroup<Reuse, Alloc, Types...>,
+                               Is...>;
+    (static_cast<StorageAt<Is> &>(this->storage_group).advise_sequential(),
+     ...);
+    return View<ViewIterator>(ViewIterator(*this, this->first_index),
+                              ViewIterator(*this, this->max_size));
+  }
+
+  /**
+   * Call `fn(begin, end, columns...)` on every run `[begin, end)` of valid
+   * slots, where `columns` are raw pointers to the element `begin` of every
+   * column: the element of slot `i` is `columns[i - begin]`. The body is
+   * then a plain loop over arrays that the compiler can vectorize. Runs are
+   * split where a `Paged` column crosses a page, so a packed storage of
+   * unpaged columns is a single chunk. `fn` may modify the components it is
+   * given, but must not insert or remove.
+   *
+   * Sample usage:
+   *
+   * ``` c++
+   * VecStorageGroup<float, float> storage;
+   * storage.for_each_chunk([](Entity begin, Entity end, float *x, float *v) {
+   *   for (std::size_t k = 0; k < end - begin; k++) {
+   *     x[k] += v[k];
+   *   }
+   * });
+   * ```
+   */
+  template <typename F>
+  void for_each_chunk(F fn) {
+    this->for_each_run([&](std::size_t begin, std::size_t run_end) {
+      while (begin < run_end) {
+        std::size_t end =
+            std::min(run_end, this->storage_group.contiguous_end(begin));
+        std::apply([&](auto *... columns) { fn(begin, end, columns...); },
+                   this->storage_group.data_at(begin, end - begin));
+        begin = end;
+      }
+    });
+  }
+
+  /**
+   * Get the end of the block of slots from `i` on that is contiguous in
+   * every column
+   */
+  std::size_t contiguous_end(Entity i) {
+    return this->storage_group.contiguous_end(i);
+  }
+
+  /**
+   * Get the pointers to the `count` slots from `i` on in every column, which
+   * should lie in one contiguous block (see `contiguous_end`)
+   */
+  auto data_at(Entity i, std::size_t count) {
+    return this->storage_group.data_at(i, count);
+  }
+
+  /**
+   * Call `fn(index, components...)` on every valid element in parallel. The
+   * slots are split into chunks of `PAR_CHUNK_SIZE` and run on `pool`; each
+   * worker only visits the valid slots of its chunk. `fn` may modify the
+   * components it is given, but must not insert or remove.
+   *
+   * Sample usage:
+   *
+   * ``` c++
+   * particles.par_for_each([](Entity i, Vector2f &x, Vector2f &v) {
+   *   x += v;
+   * });
+   * ```
+   */
+  template <typename F>
+  void par_for_each(ThreadPool &pool, F fn) {
+    this->storage_group.advise_sequential();
+    std::size_t max_size = this->max_size;
+    std::size_t num_chunks = (max_size + PAR_CHUNK_SIZE - 1) / PAR_CHUNK_SIZE;
+    pool.run(num_chunks, [&](std::size_t chunk) {
+      std::size_t end = std::min(max_size, (chunk + 1) * PAR_CHUNK_SIZE);
+      for (std::size_t i = this->alive.find_next(chunk * PAR_CHUNK_SIZE);
+           i < end; i = this->alive.find_next(i + 1)) {
+        std::apply(fn, std::tuple_cat(std::make_tuple(Entity(i)),
+                                      this->storage_group.get_bulk(i)));
+      }
+    });
+  }
+
+  /**
+   * Same as `par_for_each(pool, fn)`, running on the global thread pool
+   */
+  template <typename F>
+  void par_for_each(F fn) {
+    this->par_for_each(ThreadPool::global(), fn);
+  }
+
+  /**
+   * Get the memory footprint and fragmentation of this storage: the bytes
+   * used and reserved by every column, the bytes of the liveness mask and of
+   * the free slots, the live ratio and the longest run of removed slots. A
+   * low live ratio or a long dead run suggests calling `compact`.
+   */
+  StorageStats stats() {
+    StorageStats stats;
+    stats.size = this->size();
+    stats.slots = this->max_size;
+    this->storage_group.column_stats(stats.columns, this->max_size);
+    stats.index_bytes =
+        this->alive.capacity_bytes() + this->reuse.capacity_bytes();
+    for (std::size_t begin = this->alive.find_next_unset(0);
+         begin < this->max_size;) {
+      std::size_t end = this->alive.find_next(begin);
+      stats.longest_dead_run = std::max(stats.longest_dead_run, end - begin);
+      begin = this->alive.find_next_unset(end);
+    }
+    return stats;
+  }
+
+  /**
+   * Write the binary snapshot of this storage to `out`, in the format of
+   * `Snapshot.h`: the liveness mask and every column as raw bytes, removed
+   * slots included. All the component types should be bitwise copyable
+   * (see `is_bitwise_copyable`). Return `false` if the stream failed.
+   *
+   * Sample usage:
+   *
+   * ``` c++
+   * std::ofstream out("particles.bin", std::ios::binary);
+   * particles.save(out);
+   * ```
+   */
+  bool save(std::ostream &out) {
+    SnapshotWriter writer(out);
+    write_snapshot_header<Types...>(writer, SnapshotKind::Vec, this->max_size,
+                                    this->size());
+    writer.write_column(this->alive.words_span());
+    this->save_columns(writer, std::index_sequence_for<Types...>());
+    return writer.good();
+  }
+
+  /**
+   * Load a snapshot written by `save` into this storage, which should be
+   * empty. The entities are the same as in the saved storage. Return `false`
+   * if this storage is not empty or `snapshot` is not of a vec storage.
+   *
+   * Sample usage:
+   *
+   * ``` c++
+   * auto snapshot = SnapshotView<float, Vector2f>::open("particles.bin");
+   * VecStorageGroup<float, Vector2f> particles;
+   * if (!snapshot || !particles.restore(*snapshot)) {
+   *   // Handle the error
+   * }
+   * ```
+   */
+  bool restore(const SnapshotView<Types...> &snapshot) {
+    if (snapshot.snapshot_kind() != SnapshotKind::Vec || this->max_size != 0) {
+      return false;
+    }
+    this->max_size = snapshot._max_size();
+    this->num_removed = this->max_size - snapshot.size();
+    this->storage_group.push_many(snapshot.all_columns(), 0, this->max_size);
+    this->alive.assign(snapshot.liveness(), this->max_size);
+    this->first_index = this->alive.find_next(0);
+    this->refill_reuse();
+    return true;
   }
 
   template <class... DSS>
-  JoinedStorageGroup<VecStorageGroup<Types...>, DSS...> join(DSS &... dss) {
+  JoinedStorageGroup<BasicVecStorageGroup<Reuse, Alloc, Types...>, DSS...>
+  join(DSS &... dss) {
     return JoinedStorageGroup(*this, dss...);
   }
 
+  /**
+   * Make an owning group of this storage with `dss`, which keeps the joined
+   * elements packed at the front of every dense storage (see `OwningGroup`)
+   */
+  template <class... DSS>
+  OwningGroup<BasicVecStorageGroup<Reuse, Alloc, Types...>, DSS...>
+  own(DSS &... dss) {
+    return OwningGroup<BasicVecStorageGroup<Reuse, Alloc, Types...>, DSS...>(
+        *this, dss...);
+  }
+
+  /**
+   * Make a command buffer recording inserts and removes on this storage and
+   * `dss`, to apply them after an iteration (see `CommandBuffer`)
+   */
+  template <class... DSS>
+  CommandBuffer<BasicVecStorageGroup<Reuse, Alloc, Types...>, DSS...>
+  commands(DSS &... dss) {
+    return CommandBuffer<BasicVecStorageGroup<Reuse, Alloc, Types...>,
+                         DSS...>(*this, dss...);
+  }
+
 private:
   Entity first_index;
   std::size_t max_size;
-  std::unordered_set<Entity> removed_indices;
-  StorageGroup<Types...> storage_group;
+  std::size_t num_removed;
+
+  // One bit per slot up to `max_size`, set when the slot holds valid data.
+  BitSet alive;
+
+  // The removed slots that are available for reuse by `insert`.
+  Reuse reuse;
+
+  Group storage_group;
 
-  bool is_valid(Entity i) { return i < this->max_size && !this->is_removed(i); }
+  bool is_valid(Entity i) { return i < this->max_size && this->alive.test(i); }
 
-  bool is_removed(Entity i) {
-    auto it = this->removed_indices.find(i);
-    return it != this->removed_indices.end();
+  /**
+   * Call `fn(begin, end)` on every maximal run `[begin, end)` of valid slots
+   */
+  template <typename F>
+  void for_each_run(F fn) {
+    for (std::size_t begin = this->first_index; begin < this->max_size;) {
+      std::size_t end = this->alive.find_next_unset(begin);
+      fn(begin, end);
+      begin = this->alive.find_next(end);
+    }
+  }
+
+  /**
+   * Call `out(elems, count)` on the blocks of the component column `Index`
+   * covering the slots `[begin, end)`, split where the column is not
+   * contiguous. Reading a `Tracked` column this way is not a write.
+   */
+  template <std::size_t Index, typename Out>
+  void copy_column(std::size_t begin, std::size_t end, Out out) {
+    using S = StorageAt<Index>;
+    S &storage = static_cast<S &>(this->storage_group);
+    auto column = storage.span();
+    while (begin < end) {
+      std::size_t stop = std::min(end, storage.contiguous_end(begin));
+      out(&column[begin], stop - begin);
+      begin = stop;
+    }
+  }
+
+  /**
+   * Walk the valid slots a liveness word at a time: call `run(begin, end)`
+   * on every run of fully valid words, and `one(i)` on every valid slot `i`
+   * of the other words, in order
+   */
+  template <typename Run, typename One>
+  void for_each_valid(Run run, One one) {
+    constexpr BitSet::Word FULL = ~BitSet::Word(0);
+    Span<const BitSet::Word> words = this->alive.words_span();
+    for (std::size_t w = this->first_index / BitSet::WORD_BITS;
+         w < words.size(); w++) {
+      BitSet::Word word = words[w];
+      if (word == FULL) {
+        std::size_t begin = w * BitSet::WORD_BITS;
+        while (w + 1 < words.size() && words[w + 1] == FULL) {
+          w++;
+        }
+        run(begin, (w + 1) * BitSet::WORD_BITS);
+      } else {
+        for (; word != 0; word &= word - 1) {
+          one(w * BitSet::WORD_BITS + count_trailing_zeros(word));
+        }
+      }
+    }
+  }
+
+  /**
+   * Append the valid elements of the component columns `Is...` to the
+   * matching vectors of `results`, the `Ks`th to the `Ks`th, in one pass
+   */
+  template <std::size_t... Is, typename Results, std::size_t... Ks>
+  void extract_columns(Results results, std::index_sequence<Ks...>) {
+    auto columns = std::make_tuple(
+        static_cast<StorageAt<Is> &>(this->storage_group).span()...);
+    this->for_each_valid(
+        [&](std::size_t begin, std::size_t end) {
+          (this->copy_column<Is>(
+               begin, end,
+               [&](const TypeAt<Is> *elems, std::size_t count) {
+                 auto &result = std::get<Ks>(results);
+                 result.insert(result.end(), elems, elems + count);
+               }),
+           ...);
+        },
+        [&](std::size_t i) {
+          (std::get<Ks>(results).push_back(std::get<Ks>(columns)[i]), ...);
+        });
+  }
+
+  /**
+   * Refill the reuse policy with all the holes below `max_size`, pushed so
+   * that the lowest ones are popped first by a LIFO policy
+   */
+  void refill_reuse() {
+    this->reuse.clear();
+    std::vector<Entity> holes;
+    for (Entity hole = this->alive.find_next_unset(0); hole < this->max_size;
+         hole = this->alive.find_next_unset(hole + 1)) {
+      holes.push_back(hole);
+    }
+    for (auto hole = holes.rbegin(); hole != holes.rend(); hole++) {
+      this->reuse.push(*hole);
+    }
+  }
+
+  template <std::size_t... Indices>
+  void save_columns(SnapshotWriter &writer, std::index_sequence<Indices...>) {
+    (writer.write_column(this->template column<Indices>()), ...);
+  }
+
+  void truncate_dead_tail() {
+    std::size_t last = this->alive.find_last();
+    this->max_size = last == this->alive.size() ? 0 : last + 1;
+    this->alive.resize(this->max_size, false);
+    this->storage_group.truncate(this->max_size);
+  }
+
+  template <typename Tuple>
+  Entity append_from(Tuple &&args) {
+    Entity index = this->max_size++;
+    this->storage_group.push_bulk(std::forward<Tuple>(args));
+    this->alive.push(true);
+    return index;
+  }
+
+  template <typename Tuple>
+  bool update_from(Entity i, Tuple &&args) {
+    if (this->is_valid(i)) {
+      this->storage_group.set_bulk(i, std::forward<Tuple>(args));
+      return true;
+    }
+    return false;
   }
 };
 
+template <typename... Types>
+using VecStorageGroup = BasicVecStorageGroup<LifoReuse, DefaultAlloc, Types...>;
+
 #endif
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "storage_utils/DenseStorageGroup.h"
+#include <assert.h>
 
 using Store = DenseStorageGroup<float, float>;
 
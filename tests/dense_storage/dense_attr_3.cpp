@@ -1,4 +1,5 @@
 #include "storage_utils/Prelude.h"
+#include <assert.h>
 
 using Vector2f = std::tuple<float, float>;
 
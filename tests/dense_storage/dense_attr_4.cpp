@@ -0,0 +1,30 @@
+#include "storage_utils/DenseStorageGroup.h"
+#include <assert.h>
+
+using Hardenings = DenseStorageGroup<float, std::size_t>;
+
+int main() {
+  Hardenings hardenings;
+  for (int i = 0; i < 100; i++) {
+    hardenings.insert(i * 3, i, i * 3);
+  }
+  for (int i = 0; i < 100; i += 4) {
+    hardenings.remove(i * 3);
+  }
+
+  // The columns are packed and cover only the contained elements
+  auto h = hardenings.column<0>();
+  auto ids = hardenings.column<1>();
+  auto entities = hardenings.entities();
+  assert(h.size() == 75 && ids.size() == 75 && entities.size() == 75);
+
+  for (std::size_t i = 0; i < h.size(); i++) {
+    assert(ids[i] == entities[i]);
+    assert(h[i] * 3 == entities[i]);
+    h[i] *= 2;
+  }
+
+  for (auto [entity, hardening, id] : hardenings) {
+    assert(hardening * 3 == entity * 2);
+  }
+}
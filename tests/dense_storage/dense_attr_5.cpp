@@ -0,0 +1,56 @@
+#include "storage_utils/DenseStorageGroup.h"
+#include <assert.h>
+
+using Hardenings = DenseStorageGroup<float>;
+
+int main() {
+  Hardenings hardenings;
+
+  // Far apart entities only allocate the pages around them
+  hardenings.insert(100000000, 1.0);
+  hardenings.insert(3, 2.0);
+  hardenings.insert(100000001, 3.0);
+  assert(hardenings.size() == 3);
+
+  assert(hardenings.get_component<0>(100000000).value() == 1.0);
+  assert(hardenings.get_component<0>(3).value() == 2.0);
+  assert(hardenings.get_component<0>(100000001).value() == 3.0);
+
+  // Entities in unallocated pages, beyond the page table, or in allocated
+  // pages but not inserted are not contained
+  assert(!hardenings.contains(50000000));
+  assert(!hardenings.contains(200000000));
+  assert(!hardenings.contains(4));
+  assert(!hardenings.contains(99999999));
+  assert(!hardenings.get(50000000).has_value());
+  assert(!hardenings.update(200000000, 0.0));
+  assert(!hardenings.remove(4));
+
+  // Remove swaps the last element into the hole and updates its index
+  assert(hardenings.remove(100000000));
+  assert(!hardenings.contains(100000000));
+  assert(hardenings.get_component<0>(100000001).value() == 3.0);
+  assert(hardenings.get_component<0>(3).value() == 2.0);
+
+  // Removing the last element works as well
+  assert(hardenings.remove(100000001));
+  assert(hardenings.size() == 1);
+  assert(hardenings.get_global_index(0) == 3);
+
+  // Re-insert a removed entity
+  hardenings.insert(100000000, 4.0);
+  assert(hardenings.get_component<0>(100000000).value() == 4.0);
+
+  // Copies have their own index
+  Hardenings copy = hardenings;
+  copy.remove(3);
+  assert(hardenings.contains(3) && !copy.contains(3));
+  assert(copy.get_component<0>(100000000).value() == 4.0);
+
+  std::size_t counter = 0;
+  for (auto [entity, h] : hardenings) {
+    assert(entity == 3 || entity == 100000000);
+    counter += 1;
+  }
+  assert(counter == 2);
+}
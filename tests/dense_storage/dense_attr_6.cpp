@@ -0,0 +1,73 @@
+#include "storage_utils/DenseStorageGroup.h"
+#include <assert.h>
+
+using Hardenings = DenseStorageGroup<float, std::size_t>;
+
+int main() {
+  Hardenings hardenings;
+
+  // Insert 0, 2, 4, ..., 198 as a batch
+  std::vector<Entity> entities;
+  std::vector<float> values;
+  std::vector<std::size_t> ids;
+  for (int i = 0; i < 100; i++) {
+    entities.push_back(i * 2);
+    values.push_back(i);
+    ids.push_back(i * 2);
+  }
+  hardenings.insert_many(entities, values, ids);
+  assert(hardenings.size() == 100);
+  for (int i = 0; i < 100; i++) {
+    assert(hardenings.get_component<0>(i * 2).value() == i);
+  }
+
+  // Remove some to leave a dead tail, then insert a batch mixing existing,
+  // new and duplicated entities
+  for (int i = 0; i < 10; i++) {
+    assert(hardenings.remove(i * 2));
+  }
+  std::vector<Entity> entities_2 = {1, 3, 100, 5, 5, 7, 0, 9, 11, 13, 15};
+  std::vector<float> values_2 = {1, 3, -100, 5, 55, 7, 0, 9, 11, 13, 15};
+  std::vector<std::size_t> ids_2 = {1, 3, 100, 5, 5, 7, 0, 9, 11, 13, 15};
+  hardenings.insert_many(entities_2, values_2, ids_2);
+
+  assert(hardenings.size() == 90 + 9);
+  assert(hardenings.get_component<0>(100).value() == -100);
+  assert(hardenings.get_component<0>(5).value() == 55);
+  assert(hardenings.get_component<0>(15).value() == 15);
+  assert(hardenings.get_component<0>(0).value() == 0);
+  assert(hardenings.get_component<0>(2).has_value() == false);
+
+  // The packed columns and the entities stay consistent
+  auto entity_span = hardenings.entities();
+  auto id_span = hardenings.column<1>();
+  assert(entity_span.size() == hardenings.size());
+  for (std::size_t k = 0; k < entity_span.size(); k++) {
+    assert(id_span[k] == entity_span[k]);
+    assert(hardenings.contains(entity_span[k]));
+  }
+
+  // Many small batches grow the columns geometrically rather than
+  // reallocating them on every batch
+  Hardenings spawned;
+  std::size_t reallocations = 0;
+  const float *data = nullptr;
+  for (std::size_t batch = 0; batch < 1000; batch++) {
+    std::vector<Entity> batch_entities;
+    std::vector<float> batch_values;
+    std::vector<std::size_t> batch_ids;
+    for (std::size_t k = 0; k < 16; k++) {
+      batch_entities.push_back(batch * 16 + k);
+      batch_values.push_back(batch);
+      batch_ids.push_back(batch * 16 + k);
+    }
+    spawned.insert_many(batch_entities, batch_values, batch_ids);
+    if (spawned.column<0>().data() != data) {
+      data = spawned.column<0>().data();
+      reallocations += 1;
+    }
+  }
+  assert(spawned.size() == 16000);
+  assert(reallocations < 32);
+  assert(spawned.get_component<0>(15999).value() == 999);
+}
@@ -0,0 +1,73 @@
+#include "storage_utils/DenseStorageGroup.h"
+#include <assert.h>
+
+// Hardening, and the entity it belongs to
+using Hardenings = DenseStorageGroup<float, Entity>;
+
+// Theta_c, theta_s
+using Deformations = DenseStorageGroup<float, float>;
+
+// Check that every element is still found from its entity
+void check(Hardenings &hardenings) {
+  for (auto [i, h, owner] : hardenings) {
+    assert(owner == i && h == i * 0.5f);
+    assert(hardenings.get_component<1>(i).value() == i);
+  }
+}
+
+int main() {
+  Hardenings hardenings;
+  Deformations deformations;
+
+  // Insert in a scrambled order, then remove some to swap the last elements
+  // into the holes
+  for (Entity k = 0; k < 1000; k++) {
+    Entity i = (k * 7919) % 1000;
+    hardenings.insert(i, i * 0.5f, i);
+    if (i % 3 == 0) {
+      deformations.insert(i, i, -float(i));
+    }
+  }
+  for (Entity i = 0; i < 1000; i += 5) {
+    hardenings.remove(i);
+  }
+  assert(hardenings.size() == 800);
+  check(hardenings);
+
+  // Sorting by entity
+  hardenings.sort_by_entity();
+  assert(hardenings.size() == 800);
+  auto entities = hardenings.entities();
+  for (std::size_t k = 1; k < entities.size(); k++) {
+    assert(entities[k - 1] < entities[k]);
+  }
+  check(hardenings);
+
+  // Sorting an already sorted storage keeps it as is
+  hardenings.sort_by_entity();
+  check(hardenings);
+
+  // Match the order of the deformations: the shared entities first, in the
+  // order of the deformations, then the rest
+  hardenings.sort_like(deformations);
+  check(hardenings);
+  entities = hardenings.entities();
+  std::size_t k = 0;
+  for (Entity i : deformations.entities()) {
+    if (hardenings.contains(i)) {
+      assert(entities[k++] == i);
+    }
+  }
+  for (; k < entities.size(); k++) {
+    assert(!deformations.contains(entities[k]));
+    assert(k == 0 || deformations.contains(entities[k - 1]) ||
+           entities[k - 1] < entities[k]);
+  }
+
+  // Inserting and removing still works after the permutation
+  hardenings.insert(0, 0.0f, 0);
+  hardenings.remove(1);
+  hardenings.insert(1, 0.5f, 1);
+  assert(hardenings.size() == 801);
+  check(hardenings);
+}
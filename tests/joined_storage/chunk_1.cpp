@@ -0,0 +1,104 @@
+#include "storage_utils/Prelude.h"
+#include <assert.h>
+#include <vector>
+
+// Mass, Velocity
+using Particles = VecStorageGroup<float, float>;
+
+// Mass, Velocity in pages of 16
+using PagedParticles = VecStorageGroup<float, Paged<float, 16>>;
+
+// Hardening
+using Hardenings = DenseStorageGroup<double>;
+
+int main() {
+  Particles particles;
+  PagedParticles paged;
+  Hardenings hardenings;
+  for (int i = 0; i < 100; i++) {
+    particles.insert(i, 1.0);
+    paged.insert(i, 1.0);
+  }
+
+  // A packed storage is a single chunk
+  std::size_t chunks = 0;
+  particles.for_each_chunk([&](Entity begin, Entity end, float *m, float *v) {
+    assert(begin == 0 && end == 100);
+    for (std::size_t k = 0; k < end - begin; k++) {
+      m[k] += v[k];
+    }
+    chunks++;
+  });
+  assert(chunks == 1);
+  assert(particles.get_component_unchecked<0>(42) == 43.0);
+
+  // Chunks stop at the removed slots
+  particles.remove(0);
+  particles.remove(10);
+  particles.remove(11);
+  particles.remove(99);
+  std::vector<std::pair<Entity, Entity>> runs;
+  particles.for_each_chunk([&](Entity begin, Entity end, float *m, float *) {
+    assert(m[0] == begin + 1);
+    runs.emplace_back(begin, end);
+  });
+  assert(runs.size() == 2);
+  assert(runs[0] == std::make_pair(Entity(1), Entity(10)));
+  assert(runs[1] == std::make_pair(Entity(12), Entity(99)));
+
+  // Chunks stop at the pages of a paged column
+  paged.remove(40);
+  runs.clear();
+  paged.for_each_chunk([&](Entity begin, Entity end, float *m, float *v) {
+    for (std::size_t k = 0; k < end - begin; k++) {
+      assert(m[k] == begin + k && v[k] == 1.0);
+    }
+    runs.emplace_back(begin, end);
+  });
+  std::vector<std::pair<Entity, Entity>> expected = {
+      {0, 16}, {16, 32}, {32, 40}, {41, 48}, {48, 64}, {64, 80}, {80, 96},
+      {96, 100}};
+  assert(runs == expected);
+
+  // A dense storage is a single chunk of packed positions
+  for (Entity i = 60; i > 20; i--) {
+    hardenings.insert(i, i);
+  }
+  chunks = 0;
+  hardenings.for_each_chunk([&](std::size_t begin, std::size_t end, double *h) {
+    assert(begin == 0 && end == 40);
+    assert(h[0] == 60 && h[39] == 21);
+    chunks++;
+  });
+  assert(chunks == 1);
+
+  // A join is chunked where the entities are consecutive in every storage
+  runs.clear();
+  particles.join(hardenings).for_each_chunk(
+      [&](Entity begin, Entity end, float *m, float *, double *h) {
+        assert(m[0] == begin + 1 && h[0] == begin);
+        runs.emplace_back(begin, end);
+      });
+  assert(runs.size() == 40);
+  hardenings.sort_by_entity();
+  runs.clear();
+  particles.join(hardenings).for_each_chunk(
+      [&](Entity begin, Entity end, float *m, float *, double *h) {
+        for (std::size_t k = 0; k < end - begin; k++) {
+          assert(m[k] == begin + k + 1 && h[k] == begin + k);
+        }
+        runs.emplace_back(begin, end);
+      });
+  expected = {{21, 61}};
+  assert(runs == expected);
+
+  // Holes in the vec storage split the joined runs
+  particles.remove(30);
+  runs.clear();
+  particles.join(hardenings).for_each_chunk(
+      [&](Entity begin, Entity end, float *, float *, double *) {
+        runs.emplace_back(begin, end);
+      });
+  expected = {{21, 30}, {31, 61}};
+  assert(runs == expected);
+}
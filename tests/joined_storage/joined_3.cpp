@@ -0,0 +1,82 @@
+#include <storage_utils/Prelude.h>
+#include <assert.h>
+
+using Vector2f = std::tuple<float, float>;
+
+// mass (m), position (x)
+using Particles = VecStorageGroup<float, Vector2f>;
+
+// theta_c (tc), theta_s (ts)
+using Deformations = DenseStorageGroup<float, float>;
+
+// hardening (h)
+using Hardenings = DenseStorageGroup<float>;
+
+int main() {
+  Particles particles;
+  Deformations deformations;
+  Hardenings hardenings;
+
+  for (int i = 0; i < 1000; i++) {
+    auto id = particles.insert(i, Vector2f(i, i));
+    if (i % 2 == 0) {
+      deformations.insert(id, i, i + 1);
+    }
+  }
+
+  // Only 1% of the particles are hardened, inserted in reverse order
+  for (int i = 990; i >= 0; i -= 10) {
+    hardenings.insert(i, i * 2);
+  }
+
+  // Remove a hardened particle, but keep its hardening around. The join
+  // should not yield it even though the hardening storage drives it.
+  particles.remove(500);
+  assert(hardenings.contains(500));
+
+  // Join driven by the hardening storage (the smallest one)
+  auto joined_1 = particles.join(deformations, hardenings);
+  assert(joined_1.plan() == 1);
+  int counter_1 = 0;
+  for (auto [id, m, x, tc, ts, h] : joined_1) {
+    assert(id % 10 == 0 && id != 500);
+    assert(m == id && tc == id && ts == id + 1 && h == id * 2);
+    counter_1 += 1;
+  }
+  assert(counter_1 == 99);
+
+  // Join driven by the deformation storage
+  auto joined_2 = particles.join(deformations);
+  assert(joined_2.plan() == 0);
+  int counter_2 = 0;
+  for (auto [id, m, x, tc, ts] : joined_2) {
+    assert(id % 2 == 0 && id != 500);
+    assert(m == id && tc == id);
+    counter_2 += 1;
+  }
+  assert(counter_2 == 499);
+
+  // Join driven by the particles once they are the smallest storage. The
+  // order of iteration is then the order of the particle indices.
+  for (int i = 0; i < 1000; i++) {
+    if (i % 100 != 0) {
+      particles.remove(i);
+    }
+  }
+  auto joined_3 = particles.join(deformations, hardenings);
+  assert(joined_3.plan() == decltype(joined_3)::VEC_DRIVER);
+  std::size_t last_id = 0, counter_3 = 0;
+  for (auto [id, m, x, tc, ts, h] : joined_3) {
+    assert(id % 100 == 0 && id >= last_id);
+    last_id = id;
+    counter_3 += 1;
+  }
+  assert(counter_3 == 9);
+
+  // Writes through the join are visible in the storages
+  for (auto [id, m, x, h] : particles.join(hardenings)) {
+    h = -1.0;
+  }
+  assert(hardenings.get_component<0>(100).value() == -1.0);
+  assert(hardenings.get_component<0>(110).value() == 220.0);
+}
@@ -0,0 +1,95 @@
+#include <storage_utils/Prelude.h>
+#include <assert.h>
+
+using Vector2f = std::tuple<float, float>;
+
+// mass (m), position (x)
+using Particles = VecStorageGroup<float, Vector2f>;
+
+// hardening (h)
+using Hardenings = DenseStorageGroup<float>;
+
+// Check that the joined hardening of every particle is still its own
+void check_join(Particles &particles, Hardenings &hardenings, int expected) {
+  int counter = 0;
+  for (auto [i, m, x, h] : particles.join(hardenings)) {
+    assert(m == h);
+    assert(m == std::get<0>(x));
+    counter++;
+  }
+  assert(counter == expected);
+}
+
+int main() {
+  Particles particles;
+  Hardenings hardenings;
+
+  for (int i = 0; i < 1000; i++) {
+    auto id = particles.insert(i, Vector2f(i, i));
+    if (i % 3 == 0) {
+      hardenings.insert(id, i);
+    }
+  }
+
+  // Remove every other particle, keeping the hardening of a few of them
+  // around as stale elements
+  for (Entity i = 0; i < 1000; i += 2) {
+    particles.remove(i);
+    if (i % 4 == 0) {
+      hardenings.remove(i);
+    }
+  }
+  assert(particles.size() == 500);
+  assert(particles._max_size() == 1000);
+  check_join(particles, hardenings, 167);
+
+  // Move at most 100 elements; the dead slot at the end is dropped as well
+  EntityRemap moves = particles.compact_incremental(100, hardenings);
+  assert(moves.size() == 100);
+  assert(particles.size() == 500);
+  assert(particles._max_size() < 1000);
+  for (auto &move : moves) {
+    assert(move.to < move.from);
+    assert(particles.contains(move.to) && !particles.contains(move.from));
+  }
+  check_join(particles, hardenings, 167);
+
+  // The holes left are filled lowest first
+  Entity hole = 0;
+  while (particles.contains(hole)) {
+    hole++;
+  }
+  assert(hole == 200);
+  assert(particles.insert(-1, Vector2f(-1, -1)) == hole);
+  particles.remove(hole);
+
+  // Finish the compaction
+  moves = particles.compact(hardenings);
+  assert(particles.size() == 500);
+  assert(particles._max_size() == 500);
+  for (Entity i = 0; i < 500; i++) {
+    assert(particles.contains(i));
+  }
+
+  // The stale hardenings left at the destination of a move are dropped, so
+  // that they are not joined with the moved particles
+  check_join(particles, hardenings, 167);
+
+  // Nothing to do on a packed storage
+  assert(particles.compact(hardenings).empty());
+
+  // Inserting appends again
+  assert(particles.insert(1000, Vector2f(1000, 1000)) == 500);
+
+  // Compacting a storage with only removed elements empties it
+  Particles empty;
+  for (int i = 0; i < 10; i++) {
+    empty.insert(i, Vector2f(i, i));
+  }
+  for (Entity i = 0; i < 10; i++) {
+    empty.remove(i);
+  }
+  assert(empty.compact().empty());
+  assert(empty._max_size() == 0 && empty.is_empty());
+  assert(empty.insert(0, Vector2f(0, 0)) == 0);
+}
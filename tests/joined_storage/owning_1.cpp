@@ -0,0 +1,115 @@
+#include "storage_utils/Prelude.h"
+#include <assert.h>
+#include <set>
+
+using Vector2f = std::tuple<float, float>;
+
+// mass (m), position (x)
+using Particles = VecStorageGroup<float, Vector2f>;
+
+// theta_c (tc), theta_s (ts)
+using Deformations = DenseStorageGroup<float, float>;
+
+// hardening (h)
+using Hardenings = DenseStorageGroup<float>;
+
+// Check the group against the plain join of the same storages
+template <typename Group>
+void check(Group &group, Particles &particles, Deformations &deformations,
+           Hardenings &hardenings) {
+  std::set<Entity> joined;
+  for (auto [i, m, x, tc, ts, h] :
+       particles.join(deformations, hardenings)) {
+    joined.insert(i);
+  }
+  assert(group.size() == joined.size());
+
+  // The group is at the front of both dense storages, in the same order
+  std::set<Entity> owned;
+  for (std::size_t k = 0; k < group.size(); k++) {
+    Entity i = deformations.get_global_index(k);
+    assert(hardenings.get_global_index(k) == i);
+    owned.insert(i);
+  }
+  assert(owned == joined);
+
+  // Every element carries its own components
+  std::size_t count = 0;
+  for (auto [i, m, x, tc, ts, h] : group) {
+    assert(m == i && tc == i && ts == -float(i) && h == i * 2.0f);
+    assert(group.contains(i));
+    count++;
+  }
+  assert(count == group.size());
+  auto column = group.template column<1, 0>();
+  for (std::size_t k = 0; k < column.size(); k++) {
+    assert(column[k] == group.entities()[k] * 2.0f);
+  }
+}
+
+int main() {
+  Particles particles;
+  Deformations deformations;
+  Hardenings hardenings;
+
+  // Build some storages before owning them
+  for (int i = 0; i < 1000; i++) {
+    auto id = particles.insert(i, Vector2f(i, i));
+    if (i % 2 == 0) {
+      deformations.insert(id, i, -i);
+    }
+    if (i % 3 == 0) {
+      hardenings.insert(id, i * 2);
+    }
+  }
+  auto group = particles.own(deformations, hardenings);
+  check(group, particles, deformations, hardenings);
+
+  // Remove through the group
+  for (Entity i = 0; i < 1000; i += 5) {
+    group.remove(i);
+  }
+  for (Entity i = 0; i < 1000; i += 7) {
+    group.remove_from<0>(i);
+  }
+  for (Entity i = 0; i < 1000; i += 11) {
+    group.remove_from<1>(i);
+  }
+  check(group, particles, deformations, hardenings);
+
+  // Insert through the group, reusing the removed slots
+  for (int k = 0; k < 100; k++) {
+    Entity i = group.insert(0.0, Vector2f(0, 0));
+    particles.update(i, i, Vector2f(i, i));
+    if (!deformations.contains(i)) {
+      group.insert_into<0>(i, float(i), -float(i));
+    }
+    if (k % 2 == 0 && !hardenings.contains(i)) {
+      group.insert_into<1>(i, i * 2.0f);
+    }
+  }
+  check(group, particles, deformations, hardenings);
+
+  // Insert directly, then include
+  for (Entity i = 1; i < 1000; i += 2) {
+    if (particles.contains(i) && !deformations.contains(i)) {
+      deformations.insert(i, i, -float(i));
+      group.include(i);
+    }
+  }
+  check(group, particles, deformations, hardenings);
+
+  // Exclude, then remove directly
+  for (Entity i = 0; i < 1000; i += 13) {
+    group.exclude(i);
+    hardenings.remove(i);
+  }
+  check(group, particles, deformations, hardenings);
+
+  // Run in parallel
+  group.par_for_each([](Entity, float &m, Vector2f &x, float &, float &,
+                        float &h) { std::get<0>(x) = m + h; });
+  for (auto [i, m, x, tc, ts, h] : group) {
+    assert(std::get<0>(x) == i * 3.0f);
+  }
+}
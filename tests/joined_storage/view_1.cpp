@@ -0,0 +1,69 @@
+#include "storage_utils/Prelude.h"
+#include <assert.h>
+
+using Vector2f = std::tuple<float, float>;
+
+// Mass, Position, Velocity tracked
+using Particles = VecStorageGroup<float, Vector2f, Tracked<Vector2f>>;
+
+// Hardening, Deformation in pages of 16
+using Hardenings = DenseStorageGroup<double, Paged<int, 16>>;
+
+// Charge
+using Charges = DenseStorageGroup<int>;
+
+int main() {
+  Particles particles;
+  Hardenings hardenings;
+  Charges charges;
+  for (int i = 0; i < 100; i++) {
+    auto id = particles.insert(i, Vector2f(i, 0), Vector2f(1, 1));
+    if (i % 2 == 0) {
+      hardenings.insert(id, 2.0, i);
+    }
+    if (i % 5 == 0) {
+      charges.insert(id, -1);
+    }
+  }
+  particles.remove(10);
+
+  // A vec view yields only the chosen components, by reference
+  std::uint64_t seen = particles.advance_version<2>();
+  std::size_t count = 0;
+  for (auto [i, x, m] : particles.view<1, 0>()) {
+    assert(i != 10 && m == i && std::get<0>(x) == i);
+    std::get<1>(x) = m;
+    count++;
+  }
+  assert(count == 99);
+  assert(std::get<1>(particles.get_component_unchecked<1>(42)) == 42);
+
+  // The velocities were not touched by the view
+  bool touched = false;
+  particles.for_each_changed<2>(
+      seen, [&](Entity, const Vector2f &) { touched = true; });
+  assert(!touched);
+
+  // A dense view, including a paged column
+  count = 0;
+  for (auto [i, d] : hardenings.view<1>()) {
+    assert(d == int(i));
+    d = -d;
+    count++;
+  }
+  assert(count == 50);
+  assert(hardenings.get_component_unchecked<1>(20) == -20);
+
+  // A joined view numbers the vec components first, then the dense ones
+  count = 0;
+  for (auto [i, m, h, c] :
+       particles.join(hardenings, charges).view<0, 3, 5>()) {
+    assert(i % 10 == 0 && i != 10);
+    assert(h == 2.0 && c == -1);
+    m *= h;
+    count++;
+  }
+  assert(count == 9);
+  assert(particles.get_component_unchecked<0>(20) == 40.0);
+  assert(particles.get_component_unchecked<0>(25) == 25.0);
+}
@@ -0,0 +1,124 @@
+#include "storage_utils/Prelude.h"
+#include <assert.h>
+#include <atomic>
+#include <vector>
+
+using Vector2f = std::tuple<float, float>;
+
+// Emitter, Position in pages of 64
+using Particles = VecStorageGroup<int, Paged<Vector2f, 64>>;
+
+// Emitter, Position tracked
+using TrackedParticles = VecStorageGroup<int, Tracked<Vector2f>>;
+
+// Emitter, Position in tiles of 8
+using TiledParticles =
+    BasicVecStorageGroup<LifoReuse, AoSoA<8>, int, Vector2f>;
+
+int main() {
+  ThreadPool pool(4);
+  Particles particles;
+  for (int i = 0; i < 10; i++) {
+    particles.insert(-1, Vector2f(i, 0));
+  }
+  particles.remove(3);
+
+  // Emitters append concurrently; nothing is visible until the commit
+  auto appender = particles.append_concurrently(1000);
+  pool.run(8, [&](std::size_t emitter) {
+    for (int k = 0; k < 100; k++) {
+      auto id = appender.append(int(emitter), Vector2f(k, emitter));
+      assert(id);
+    }
+  });
+  assert(particles.size() == 9 && appender.size() == 800);
+  std::size_t committed = appender.commit();
+  assert(committed == 800);
+  committed = appender.commit();
+  assert(committed == 0);
+  assert(particles.size() == 809 && particles._max_size() == 810);
+  assert(!particles.contains(3) && particles.contains(809));
+
+  // Every emitted particle is there exactly once
+  std::vector<int> seen(800, 0);
+  for (auto [i, emitter, x] : particles) {
+    if (emitter >= 0) {
+      assert(std::get<1>(x) == emitter);
+      seen[emitter * 100 + int(std::get<0>(x))]++;
+    }
+  }
+  for (int count : seen) {
+    assert(count == 1);
+  }
+
+  // The appends past the capacity are refused
+  std::atomic<int> accepted(0);
+  {
+    auto bounded = particles.append_concurrently(50);
+    pool.run(8, [&](std::size_t emitter) {
+      for (int k = 0; k < 10; k++) {
+        if (bounded.append(int(emitter), Vector2f(0, 0))) {
+          accepted++;
+        }
+      }
+    });
+  }
+  assert(accepted == 50 && particles.size() == 859);
+
+  // Claimed ranges are cut at the capacity
+  auto batched = particles.append_concurrently(100);
+  auto [first, middle] = batched.claim(64);
+  auto [next, last] = batched.claim(64);
+  assert(first == 860 && middle == 924 && next == 924 && last == 960);
+  auto [none, none_end] = batched.claim(1);
+  assert(none == none_end);
+  for (Entity i = first; i < last; i++) {
+    batched.set(i, 7, Vector2f(i, 0));
+  }
+  committed = batched.commit();
+  assert(committed == 100);
+  assert(particles.get_component_unchecked<0>(959) == 7);
+
+  // An unused session leaves the storage as it was, and the hole is reused
+  particles.append_concurrently(10);
+  assert(particles._max_size() == 960);
+  Entity reused = particles.insert(0, Vector2f(0, 0));
+  assert(reused == 3);
+
+  // Appended rows are changed since the version before the session, and
+  // filling them does not mark the shared blocks again
+  TrackedParticles tracked;
+  tracked.insert(-1, Vector2f(0, 0));
+  std::uint64_t since = tracked.advance_version<1>();
+  {
+    auto tracked_appender = tracked.append_concurrently(200);
+    pool.run(4, [&](std::size_t emitter) {
+      for (int k = 0; k < 50; k++) {
+        tracked_appender.append(int(emitter), Vector2f(k, emitter));
+      }
+    });
+  }
+  std::size_t changed = 0;
+  tracked.for_each_changed<1>(since, [&](Entity i, const Vector2f &x) {
+    assert(i > 0 && std::get<1>(x) == tracked.get_component_unchecked<0>(i));
+    changed++;
+  });
+  assert(changed == 200);
+
+  // Tiled columns are extended by whole tiles
+  TiledParticles tiled;
+  tiled.insert(-1, Vector2f(0, 0));
+  {
+    auto tiled_appender = tiled.append_concurrently(20);
+    pool.run(4, [&](std::size_t emitter) {
+      for (int k = 0; k < 3; k++) {
+        tiled_appender.append(int(emitter), Vector2f(k, emitter));
+      }
+    });
+  }
+  assert(tiled.size() == 13);
+  assert(tiled.column<0>().num_tiles() == 2);
+  for (auto [i, emitter, x] : tiled) {
+    assert(i == 0 || std::get<1>(x) == emitter);
+  }
+}
@@ -0,0 +1,78 @@
+#include "storage_utils/Prelude.h"
+#include <assert.h>
+
+// mass, visit count
+using Particles = VecStorageGroup<float, int>;
+
+// hardening, visit count
+using Hardenings = DenseStorageGroup<float, int>;
+
+int main() {
+  ThreadPool pool(4);
+  assert(pool.num_threads() == 4);
+
+  Particles particles;
+  Hardenings hardenings;
+  for (int i = 0; i < 10000; i++) {
+    auto id = particles.insert(i, 0);
+    if (i % 7 == 0) {
+      hardenings.insert(id, i, 0);
+    }
+  }
+
+  // Remove a dead run crossing chunk boundaries, plus every third particle
+  for (int i = 1000; i < 3000; i++) {
+    particles.remove(i);
+  }
+  for (int i = 3000; i < 10000; i += 3) {
+    particles.remove(i);
+  }
+
+  // Every valid particle should be visited exactly once
+  particles.par_for_each(pool, [](Entity i, float &mass, int &visits) {
+    assert(mass == i);
+    visits += 1;
+  });
+  std::size_t counter_1 = 0;
+  for (auto [index, mass, visits] : particles) {
+    assert(visits == 1);
+    counter_1 += 1;
+  }
+  assert(counter_1 == particles.size());
+
+  // Same for the dense storage
+  hardenings.par_for_each(pool, [](Entity i, float &h, int &visits) {
+    assert(h == i);
+    visits += 1;
+  });
+  for (auto [index, h, visits] : hardenings) {
+    assert(visits == 1);
+  }
+
+  // And for the join, which should not see the removed particles
+  particles.join(hardenings).par_for_each(
+      pool, [&](Entity i, float &mass, int &visits, float &h, int &h_visits) {
+        assert(particles.contains(i));
+        assert(mass == h);
+        visits += 1;
+        h_visits += 1;
+      });
+  std::size_t counter_2 = 0;
+  for (auto [index, mass, visits, h, h_visits] : particles.join(hardenings)) {
+    assert(visits == 2);
+    assert(h_visits == 2);
+    counter_2 += 1;
+  }
+  for (auto [index, h, h_visits] : hardenings) {
+    assert(h_visits == (particles.contains(index) ? 2 : 1));
+  }
+  assert(counter_2 > 0);
+
+  // The global pool and an empty storage should work as well
+  Particles empty;
+  empty.par_for_each([](Entity, float &, int &) { assert(false); });
+  particles.par_for_each([](Entity, float &, int &visits) { visits += 1; });
+  for (auto [index, mass, visits] : particles) {
+    assert(visits >= 2);
+  }
+}
@@ -0,0 +1,50 @@
+#include "storage_utils/Prelude.h"
+#include <assert.h>
+
+using Vector2f = std::tuple<float, float>;
+
+// Mass, Position tracked
+using Particles = VecStorageGroup<float, Tracked<Vector2f>>;
+
+// Charge
+using Charges = DenseStorageGroup<int>;
+
+int main() {
+  ThreadPool pool(4);
+  Particles particles;
+  Charges charges;
+  for (int i = 0; i < 20000; i++) {
+    particles.insert(i, Vector2f(i, 0));
+  }
+
+  // The charges drive the join, so the workers reach scattered particles
+  // sharing the blocks of the tracked column
+  for (Entity i = 0; i < 20000; i += 5) {
+    charges.insert((i * 7919) % 20000, 1);
+  }
+  assert(charges.size() == 4000);
+  std::uint64_t since = particles.advance_version<1>();
+  particles.join(charges).par_for_each(
+      pool, [](Entity i, float &m, Vector2f &x, int &c) {
+        std::get<1>(x) += c;
+      });
+
+  // Exactly the joined particles are changed since the version
+  std::size_t changed = 0;
+  particles.for_each_changed<1>(since, [&](Entity i, const Vector2f &x) {
+    assert(charges.contains(i) && std::get<1>(x) == 1.0);
+    changed++;
+  });
+  assert(changed == charges.size());
+
+  // Same for the vec storage driving it
+  since = particles.advance_version<1>();
+  particles.par_for_each(pool, [](Entity i, float &m, Vector2f &x) {
+    std::get<1>(x) = 0;
+  });
+  changed = 0;
+  particles.for_each_changed<1>(since, [&](Entity i, const Vector2f &x) {
+    changed++;
+  });
+  assert(changed == particles.size());
+}
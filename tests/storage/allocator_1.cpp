@@ -0,0 +1,53 @@
+#include "storage_utils/Prelude.h"
+#include <assert.h>
+#include <cstdint>
+
+using Vector3f = std::tuple<float, float, float>;
+
+// Mass, Position, with 64-byte aligned columns
+using Particles =
+    BasicVecStorageGroup<LifoReuse, AlignedAlloc<64>, float, Vector3f>;
+
+// Hardening, with 128-byte aligned columns
+using Hardenings = BasicDenseStorageGroup<AlignedAlloc<128>, double>;
+
+// Charge, with columns of 4 KB or more backed by huge pages
+using Charges = BasicVecStorageGroup<LifoReuse, HugePageAlloc<64, 4096>, int>;
+
+bool is_aligned(const void *p, std::size_t alignment) {
+  return reinterpret_cast<std::uintptr_t>(p) % alignment == 0;
+}
+
+int main() {
+  Particles particles;
+  Hardenings hardenings;
+  Charges charges;
+
+  // Check the alignment of the column bases as they get reallocated
+  for (int i = 0; i < 10000; i++) {
+    auto id = particles.insert(i, Vector3f(i, i, i));
+    hardenings.insert(id, i);
+    charges.insert(i);
+    assert(is_aligned(particles.column<0>().data(), 64));
+    assert(is_aligned(particles.column<1>().data(), 64));
+    assert(is_aligned(hardenings.column<0>().data(), 128));
+    assert(is_aligned(charges.column<0>().data(), 64));
+  }
+
+  // Columns larger than the threshold are aligned to a huge page
+  assert(is_aligned(charges.column<0>().data(), HUGE_PAGE_SIZE));
+
+  // The storages behave the same as with the default allocator
+  for (int i = 0; i < 10000; i += 2) {
+    assert(particles.remove(i));
+    assert(hardenings.remove(i));
+    assert(charges.remove(i));
+  }
+  for (auto [id, mass, position, h] : particles.join(hardenings)) {
+    assert(id % 2 == 1);
+    assert(mass == id && h == id);
+  }
+  assert(particles.size() == 5000);
+  assert(hardenings.size() == 5000);
+  assert(charges.size() == 5000);
+}
@@ -0,0 +1,104 @@
+#include "storage_utils/Prelude.h"
+#include <assert.h>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+// Count the allocations going through the global operator new
+static std::size_t num_allocations = 0;
+
+void *operator new(std::size_t size) {
+  num_allocations++;
+  if (void *p = std::malloc(size ? size : 1)) {
+    return p;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+
+using Neighbors = std::vector<int>;
+
+// Mass, neighbor list
+using Particles = VecStorageGroup<float, Neighbors>;
+
+// Neighbor list, in pages of 16
+using PagedParticles = VecStorageGroup<float, Paged<Neighbors, 16>>;
+
+// Contact list
+using Contacts = DenseStorageGroup<Neighbors>;
+
+template <typename Group>
+void test_vec() {
+  Group particles;
+  particles.reserve(16);
+  Neighbors a(8, 1), b(8, 2), c(8, 3), d(8, 4), e(8, 5), f(8, 6);
+
+  // Moving the components in allocates nothing
+  std::size_t before = num_allocations;
+  Entity i = particles.insert(1.0, std::move(a));
+  Entity j = particles.emplace(2.0, std::move(b));
+  assert(num_allocations == before);
+  assert(particles.template get_component_unchecked<1>(i).size() == 8);
+  assert(particles.template get_component_unchecked<1>(j)[0] == 2);
+
+  // Copying an lvalue allocates exactly the copy
+  before = num_allocations;
+  Entity k = particles.emplace(3.0, c);
+  assert(num_allocations == before + 1);
+  assert(c.size() == 8);
+  assert(particles.template get_component_unchecked<1>(k)[0] == 3);
+
+  // Updates move as well
+  before = num_allocations;
+  assert(particles.update(i, 4.0, std::move(d)));
+  assert(particles.template update_component<1>(j, std::move(e)));
+  assert(num_allocations == before);
+  assert(particles.template get_component_unchecked<1>(i)[0] == 4);
+  assert(particles.template get_component_unchecked<1>(j)[0] == 5);
+  assert(!particles.update(100, 0.0, Neighbors()));
+  assert(particles.update_bulk(k, std::make_tuple(5.0f, Neighbors())));
+  assert(particles.template get_component_unchecked<1>(k).empty());
+
+  // Filling a removed slot moves into it
+  particles.remove(i);
+  before = num_allocations;
+  Entity l = particles.insert(6.0, std::move(f));
+  assert(num_allocations == before);
+  assert(l == i);
+  assert(particles.template get_component_unchecked<1>(l)[0] == 6);
+}
+
+void test_dense() {
+  Contacts contacts;
+  contacts.reserve(16);
+  contacts.insert(0, Neighbors());
+  Neighbors a(8, 1), b(8, 2), c(8, 3);
+
+  // Moving the components in allocates nothing, both for the new entities
+  // and for the existing ones
+  std::size_t before = num_allocations;
+  contacts.insert(1, std::move(a));
+  contacts.emplace(2, std::move(b));
+  contacts.emplace(0, std::move(c));
+  assert(num_allocations == before);
+  assert(contacts.size() == 3);
+  assert(contacts.get_component_unchecked<0>(0)[0] == 3);
+  assert(contacts.get_component_unchecked<0>(1)[0] == 1);
+  assert(contacts.get_component_unchecked<0>(2)[0] == 2);
+
+  // Copying an lvalue allocates exactly the copy
+  Neighbors d(8, 4);
+  before = num_allocations;
+  contacts.emplace(3, d);
+  assert(num_allocations == before + 1);
+  assert(contacts.get_component_unchecked<0>(3)[0] == 4);
+}
+
+int main() {
+  test_vec<Particles>();
+  test_vec<PagedParticles>();
+  test_dense();
+}
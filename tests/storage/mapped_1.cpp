@@ -0,0 +1,58 @@
+#include "storage_utils/Prelude.h"
+#include <assert.h>
+
+using Vector2f = std::tuple<float, float>;
+
+// Mass in memory, position and velocity in mapped files
+using Particles = VecStorageGroup<float, Mapped<Vector2f>, Mapped<Vector2f>>;
+
+// Hardening in a mapped file
+using Hardenings = DenseStorageGroup<Mapped<double>>;
+
+int main() {
+  mapped_column_directory() = ".";
+  Particles particles;
+  Hardenings hardenings;
+
+  // Grow the mapped columns well past their first mapping
+  for (int i = 0; i < 100000; i++) {
+    auto id = particles.insert(i, Vector2f(i, i), Vector2f(1, -1));
+    if (i % 10 == 1) {
+      hardenings.insert(id, i * 2.0);
+    }
+  }
+  for (Entity i = 0; i < 100000; i += 2) {
+    particles.remove(i);
+    hardenings.remove(i);
+  }
+  assert(particles.size() == 50000);
+  assert(hardenings.size() == 10000);
+
+  // Iterate through the mapped columns
+  for (auto [i, m, x, v] : particles) {
+    std::get<0>(x) += std::get<0>(v);
+    std::get<1>(x) += std::get<1>(v);
+  }
+  auto x = particles.column<1>();
+  assert(x.size() == 100000);
+  for (Entity i = 1; i < 100000; i += 2) {
+    assert(std::get<0>(x[i]) == i + 1 && std::get<1>(x[i]) == i - 1.0f);
+  }
+  for (auto [i, m, x, v, h] : particles.join(hardenings)) {
+    assert(h == m * 2.0);
+  }
+
+  // Copies do not share the file
+  Particles copy = particles;
+  copy.update_component<0>(1, 0.0);
+  std::get<0>(copy.get_component_unchecked<1>(1)) = 0.0;
+  assert(std::get<0>(particles.get_component_unchecked<1>(1)) == 2.0);
+
+  // Compacting shrinks the mapped columns
+  particles.compact(hardenings);
+  assert(particles.column<1>().size() == 50000);
+  for (auto [i, m, x, v, h] : particles.join(hardenings)) {
+    assert(h == m * 2.0);
+  }
+  assert(particles.get_component<0>(0).value() == 99999);
+}
@@ -0,0 +1,72 @@
+#include "storage_utils/Prelude.h"
+#include <assert.h>
+
+using Vector2f = std::tuple<float, float>;
+
+// Mass in a plain column, position and velocity in pages of 64
+using Particles =
+    VecStorageGroup<float, Paged<Vector2f, 64>, Paged<Vector2f, 64>>;
+
+// Hardening in pages of 16
+using Hardenings = DenseStorageGroup<Paged<float, 16>>;
+
+int main() {
+  Particles particles;
+  Hardenings hardenings;
+
+  // Keep the address of the first position around
+  particles.insert(0.0, Vector2f(0.0, 0.0), Vector2f(1.0, 1.0));
+  Vector2f *first_position = &particles.get_component_unchecked<1>(0);
+
+  // The address stays stable while the columns grow by many pages
+  for (int i = 1; i < 1000; i++) {
+    auto id = particles.insert(i, Vector2f(i, i), Vector2f(1.0, 1.0));
+    if (i % 3 == 0) {
+      hardenings.insert(id, i);
+    }
+  }
+  assert(&particles.get_component_unchecked<1>(0) == first_position);
+
+  // The paged columns are iterated page by page
+  auto x = particles.column<1>();
+  auto v = particles.column<2>();
+  assert(x.size() == 1000 && x.num_pages() == 16);
+  for (std::size_t p = 0; p < x.num_pages(); p++) {
+    auto x_page = x.page(p);
+    auto v_page = v.page(p);
+    assert(x_page.size() == (p < 15 ? 64 : 1000 - 15 * 64));
+    for (std::size_t i = 0; i < x_page.size(); i++) {
+      std::get<0>(x_page[i]) += std::get<0>(v_page[i]);
+    }
+  }
+
+  // Mixed plain and paged columns behave the same through the interface
+  for (int i = 0; i < 1000; i += 2) {
+    assert(particles.remove(i));
+  }
+  std::size_t counter = 0;
+  for (auto [id, m, pos, vel] : particles) {
+    assert(m == id);
+    assert(std::get<0>(pos) == id + 1 && std::get<1>(pos) == id);
+    counter += 1;
+  }
+  assert(counter == 500);
+  assert(particles.extract<1>().size() == 500);
+
+  // Dense storages with paged columns swap on removal and stay packed
+  for (int i = 6; i < 1000; i += 6) {
+    assert(hardenings.remove(i));
+  }
+  assert(hardenings.column<0>().size() == hardenings.size());
+  for (auto [id, m, pos, vel, h] : particles.join(hardenings)) {
+    assert(id % 3 == 0 && id % 2 == 1);
+    assert(h == id);
+  }
+
+  // The groups can be copied
+  Particles copy = particles;
+  assert(copy.size() == 500);
+  assert(copy.get_component<1>(1).value() == particles.get_component<1>(1));
+  assert(&copy.get_component_unchecked<1>(1) !=
+         &particles.get_component_unchecked<1>(1));
+}
@@ -0,0 +1,139 @@
+#include "storage_utils/Prelude.h"
+#include <algorithm>
+#include <assert.h>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+using Vector2f = std::tuple<float, float>;
+
+// Mass, Position in pages of 64
+using Particles = VecStorageGroup<float, Paged<Vector2f, 64>>;
+
+// Hardening
+using Hardenings = DenseStorageGroup<double>;
+
+int main() {
+  Particles particles;
+  Hardenings hardenings;
+  for (int i = 0; i < 1000; i++) {
+    auto id = particles.insert(i, Vector2f(i, -i));
+    if (i % 7 == 0) {
+      hardenings.insert(id, i * 0.5);
+    }
+  }
+  for (Entity i = 0; i < 1000; i += 3) {
+    particles.remove(i);
+    hardenings.remove(i);
+  }
+
+  // Save both storages to files
+  {
+    std::ofstream out("particles.snapshot", std::ios::binary);
+    bool saved = particles.save(out);
+    assert(saved);
+    std::ofstream out_h("hardenings.snapshot", std::ios::binary);
+    saved = hardenings.save(out_h);
+    assert(saved);
+  }
+
+  // View the mapped particles in place
+  auto view = SnapshotView<float, Paged<Vector2f, 64>>::open(
+      "particles.snapshot");
+  assert(view);
+  assert(view->snapshot_kind() == SnapshotKind::Vec);
+  assert(view->size() == particles.size());
+  assert(view->_max_size() == 1000);
+  Span<const float> masses = view->column<0>();
+  Span<const Vector2f> positions = view->column<1>();
+  int count = 0;
+  for (Entity i = 0; i < view->_max_size(); i++) {
+    assert(view->contains(i) == particles.contains(i));
+    if (view->contains(i)) {
+      assert(masses[i] == i && std::get<1>(positions[i]) == -float(i));
+      count++;
+    }
+  }
+  assert(count == particles.size());
+
+  // Restore the particles, with the same entities and free slots
+  Particles restored;
+  bool restored_ok = restored.restore(*view);
+  assert(restored_ok);
+  restored_ok = restored.restore(*view);
+  assert(!restored_ok);
+  assert(restored.size() == particles.size());
+  for (auto [i, m, x] : particles) {
+    auto [rm, rx] = restored.get(i).value();
+    assert(rm == m && rx == x);
+  }
+  Entity reused = restored.insert(-1, Vector2f(-1, 1));
+  assert(reused == 0);
+
+  // Restore the hardenings
+  auto view_h = SnapshotView<double>::open("hardenings.snapshot");
+  assert(view_h && view_h->snapshot_kind() == SnapshotKind::Dense);
+  assert(view_h->entities().size() == hardenings.size());
+  Hardenings restored_h;
+  restored_ok = restored_h.restore(*view_h);
+  assert(restored_ok);
+  assert(restored_h.size() == hardenings.size());
+  for (auto [i, h] : hardenings) {
+    assert(restored_h.get_component<0>(i).value() == h);
+  }
+
+  // Snapshots of other column types or storage kinds are rejected
+  using Mismatched = SnapshotView<double, Vector2f>;
+  assert(!Mismatched::open("particles.snapshot"));
+  assert(!SnapshotView<float>::open("hardenings.snapshot"));
+  assert(!SnapshotView<double>::open("missing.snapshot"));
+  assert(!SnapshotView<double>::from_bytes(nullptr, 0));
+  restored_ok = restored_h.restore(*view_h);
+  assert(!restored_ok);
+
+  // Truncated snapshots are rejected
+  std::ostringstream out;
+  bool saved = hardenings.save(out);
+  assert(saved);
+  std::string bytes = out.str();
+  std::vector<char, AlignedAllocator<char, 64>> buffer(bytes.begin(),
+                                                       bytes.end());
+  assert(SnapshotView<double>::from_bytes(buffer.data(), buffer.size()));
+  assert(!SnapshotView<double>::from_bytes(buffer.data(), buffer.size() - 64));
+
+  // So are snapshots of the other byte order
+  std::reverse(buffer.begin() + 8, buffer.begin() + 12);
+  assert(!SnapshotView<double>::from_bytes(buffer.data(), buffer.size()));
+  std::reverse(buffer.begin() + 8, buffer.begin() + 12);
+
+  // Dense snapshots holding an entity twice are viewed, but not restored
+  Entity *entities = reinterpret_cast<Entity *>(buffer.data() + 64);
+  entities[0] = entities[1];
+  auto duplicated = SnapshotView<double>::from_bytes(buffer.data(),
+                                                     buffer.size());
+  assert(duplicated);
+  Hardenings rejected_h;
+  restored_ok = rejected_h.restore(*duplicated);
+  assert(!restored_ok);
+  assert(rejected_h.is_empty() && !rejected_h.contains(entities[1]));
+  restored_ok = rejected_h.restore(*view_h);
+  assert(restored_ok);
+
+  // Liveness words disagreeing with the number of valid elements, or with
+  // bits past the last slot, are rejected
+  std::ostringstream out_p;
+  saved = particles.save(out_p);
+  assert(saved);
+  bytes = out_p.str();
+  buffer.assign(bytes.begin(), bytes.end());
+  using ParticlesView = SnapshotView<float, Paged<Vector2f, 64>>;
+  assert(ParticlesView::from_bytes(buffer.data(), buffer.size()));
+  BitSet::Word *words = reinterpret_cast<BitSet::Word *>(buffer.data() + 128);
+  words[0] &= ~BitSet::Word(2);
+  assert(!ParticlesView::from_bytes(buffer.data(), buffer.size()));
+  words[1000 / 64] |= BitSet::Word(1) << 63;
+  assert(!ParticlesView::from_bytes(buffer.data(), buffer.size()));
+
+  std::remove("particles.snapshot");
+  std::remove("hardenings.snapshot");
+}
@@ -0,0 +1,74 @@
+#include "storage_utils/Prelude.h"
+#include <assert.h>
+
+using Vector2f = std::tuple<float, float>;
+
+// Mass, Position in pages of 64
+using Particles = VecStorageGroup<float, Paged<Vector2f, 64>>;
+
+// Hardening
+using Hardenings = DenseStorageGroup<double>;
+
+int main() {
+  Particles particles;
+  Hardenings hardenings;
+  particles.reserve(1000);
+  for (int i = 0; i < 1000; i++) {
+    auto id = particles.insert(i, Vector2f(i, i));
+    if (i % 2 == 0) {
+      hardenings.insert(id, i);
+    }
+  }
+
+  // A packed storage
+  StorageStats stats = particles.stats();
+  assert(stats.size == 1000 && stats.slots == 1000);
+  assert(stats.live_ratio() == 1.0);
+  assert(stats.longest_dead_run == 0);
+  assert(stats.columns.size() == 2);
+  assert(stats.columns[0].used_bytes == 1000 * sizeof(float));
+  assert(stats.columns[0].capacity_bytes >= stats.columns[0].used_bytes);
+  assert(stats.columns[1].used_bytes == 1000 * sizeof(Vector2f));
+  assert(stats.columns[1].capacity_bytes == 1024 * sizeof(Vector2f));
+  assert(stats.index_bytes >= 1000 / 8);
+  assert(stats.capacity_bytes() >= stats.index_bytes + 1000 * 12);
+
+  // Remove a run of 100, and every 4th particle after it (starting right
+  // after the run)
+  for (Entity i = 200; i < 300; i++) {
+    particles.remove(i);
+  }
+  for (Entity i = 300; i < 1000; i += 4) {
+    particles.remove(i);
+  }
+  stats = particles.stats();
+  assert(stats.size == 725 && stats.slots == 1000);
+  assert(stats.live_ratio() == 0.725);
+  assert(stats.longest_dead_run == 101);
+
+  // The run at the end of the storage counts as well
+  for (Entity i = 850; i < 1000; i++) {
+    particles.remove(i);
+  }
+  assert(particles.stats().longest_dead_run == 150);
+
+  // Dense storages are always packed
+  stats = hardenings.stats();
+  assert(stats.size == 500 && stats.slots == 500);
+  assert(stats.live_ratio() == 1.0);
+  assert(stats.columns.size() == 1);
+  assert(stats.columns[0].used_bytes == 500 * sizeof(double));
+  assert(stats.index_bytes >= SparseIndex::PAGE_SIZE * 4 + 500 * 8);
+
+  // Joined stats list every storage
+  auto joined = particles.join(hardenings).stats();
+  assert(joined.size() == 2);
+  assert(joined[0].size == particles.size());
+  assert(joined[1].size == hardenings.size());
+
+  // Compacting removes the dead runs
+  particles.compact(hardenings);
+  stats = particles.stats();
+  assert(stats.live_ratio() == 1.0 && stats.longest_dead_run == 0);
+  assert(stats.columns[1].capacity_bytes < 1024 * sizeof(Vector2f));
+}
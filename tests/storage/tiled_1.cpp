@@ -0,0 +1,98 @@
+#include "storage_utils/Prelude.h"
+#include <assert.h>
+#include <cstdio>
+#include <fstream>
+#include <vector>
+
+using Vector2f = std::tuple<float, float>;
+
+// Mass, Position, Charge in tiles of 8 particles
+using Particles =
+    BasicVecStorageGroup<LifoReuse, AoSoA<8>, float, Vector2f, char>;
+
+// Hardening, Deformation in tiles of 16
+using Hardenings = BasicDenseStorageGroup<AoSoA<16>, double, int>;
+
+int main() {
+  Particles particles;
+  Hardenings hardenings;
+  for (int i = 0; i < 100; i++) {
+    auto id = particles.insert(i, Vector2f(i, -i), char(i % 3));
+    if (i % 2 == 0) {
+      hardenings.insert(id, i * 0.5, i);
+    }
+  }
+
+  // Rows and single components read back across the tiles
+  for (Entity i = 0; i < 100; i++) {
+    auto [m, x, c] = particles.get_unchecked(i);
+    assert(m == i && std::get<1>(x) == -float(i) && c == char(i % 3));
+    assert(particles.get_component_unchecked<1>(i) == x);
+  }
+  assert(hardenings.get_component_unchecked<1>(42) == 42);
+
+  // Removing and inserting again reuses the slots in place
+  particles.remove(3);
+  particles.remove(17);
+  assert(particles.insert(-1, Vector2f(0, 0), 7) == 17);
+  particles.update(5, 10, Vector2f(1, 1), 2);
+  assert(particles.get_component_unchecked<0>(5) == 10);
+  assert(particles.get_component_unchecked<2>(17) == 7);
+  hardenings.remove(0);
+  assert(hardenings.size() == 49 && hardenings.get(98).has_value());
+
+  // A column is viewed tile by tile
+  auto masses = particles.column<0>();
+  assert(masses.size() == 100 && masses.num_tiles() == 13);
+  assert(masses.tile(12).size() == 4 && masses.tile(1)[2] == 10);
+  assert(masses[42] == 42);
+
+  // Chunks stop at the tiles
+  std::size_t chunks = 0;
+  particles.for_each_chunk(
+      [&](Entity begin, Entity end, float *m, Vector2f *x, char *) {
+        assert(end <= (begin / 8 + 1) * 8);
+        for (std::size_t k = 0; k < end - begin; k++) {
+          assert(std::get<1>(x[k]) == -m[k] || begin + k == 5 ||
+                 begin + k == 17);
+        }
+        chunks++;
+      });
+  assert(chunks == 14);
+
+  // Extracting skips the removed slot
+  std::vector<float> extracted = particles.extract<0>();
+  assert(extracted.size() == 99 && extracted[3] == 4 && extracted[5] == 6);
+
+  // Views and joins
+  std::size_t count = 0;
+  for (auto [i, m, h] : particles.join(hardenings).view<0, 3>()) {
+    assert(h == i * 0.5 && (m == i || i == 5));
+    count++;
+  }
+  assert(count == 49);
+
+  // Snapshots write the columns tile by tile
+  {
+    std::ofstream out("tiled.snapshot", std::ios::binary);
+    assert(particles.save(out));
+  }
+  auto view = SnapshotView<float, Vector2f, char>::open("tiled.snapshot");
+  assert(view);
+  Particles restored;
+  assert(restored.restore(*view));
+  assert(restored.size() == particles.size() && !restored.contains(3));
+  assert(restored.get_component_unchecked<1>(99) == Vector2f(99, -99));
+  std::remove("tiled.snapshot");
+
+  // A copy owns its tiles
+  Particles copy = particles;
+  copy.update_component<0>(42, -1);
+  assert(copy.get_component_unchecked<0>(42) == -1);
+  assert(particles.get_component_unchecked<0>(42) == 42);
+
+  // The tiles are sized for every column
+  StorageStats stats = particles.stats();
+  assert(stats.columns.size() == 3);
+  assert(stats.columns[2].used_bytes == 100);
+}
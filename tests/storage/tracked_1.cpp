@@ -0,0 +1,94 @@
+#include "storage_utils/Prelude.h"
+#include <assert.h>
+#include <vector>
+
+using Vector2f = std::tuple<float, float>;
+
+// Mass, Position tracked
+using Particles = VecStorageGroup<float, Tracked<Vector2f>>;
+
+// Hardening tracked, in pages of 64
+using Hardenings = DenseStorageGroup<Tracked<Paged<double, 64>>>;
+
+std::vector<Entity> changed(Particles &particles, std::uint64_t since) {
+  std::vector<Entity> entities;
+  particles.for_each_changed<1>(
+      since, [&](Entity i, const Vector2f &) { entities.push_back(i); });
+  return entities;
+}
+
+std::vector<Entity> changed(Hardenings &hardenings, std::uint64_t since) {
+  std::vector<Entity> entities;
+  hardenings.for_each_changed<0>(
+      since, [&](Entity i, const double &) { entities.push_back(i); });
+  return entities;
+}
+
+int main() {
+  Particles particles;
+  Hardenings hardenings;
+  for (int i = 0; i < 1000; i++) {
+    auto id = particles.insert(i, Vector2f(i, i));
+    if (i % 2 == 0) {
+      hardenings.insert(id, i);
+    }
+  }
+
+  // Every inserted element is changed since the start
+  assert(changed(particles, 0).size() == 1000);
+  assert(changed(hardenings, 0).size() == 500);
+
+  // Nothing changed since the current version
+  std::uint64_t seen = particles.advance_version<1>();
+  assert(changed(particles, seen).empty());
+
+  // Updates, component updates and bulk writes are tracked
+  particles.update(10, 0.0, Vector2f(1, 1));
+  particles.update_component<1>(700, Vector2f(2, 2));
+  particles.update_bulk(300, std::make_tuple(1.0f, Vector2f(3, 3)));
+  std::vector<Entity> expected = {10, 300, 700};
+  assert(changed(particles, seen) == expected);
+
+  // Reading the changed components is not a write
+  std::uint64_t later = particles.advance_version<1>();
+  particles.for_each_changed<1>(seen, [](Entity i, const Vector2f &x) {
+    assert(i == 10 || i == 300 || i == 700);
+  });
+  assert(changed(particles, later).empty());
+  assert(changed(particles, seen) == expected);
+
+  // Looking components up is not a write either
+  std::uint64_t looked = hardenings.advance_version<0>();
+  assert(particles.get_component<1>(20) == Vector2f(20, 20));
+  assert(hardenings.get_component<0>(40) == 40.0);
+  assert(changed(particles, later).empty());
+  assert(changed(hardenings, looked).empty());
+
+  // Mutable iteration marks every visited element
+  for (auto [i, m, x] : particles) {
+    if (i >= 500) {
+      break;
+    }
+  }
+  assert(changed(particles, later).size() == 501);
+
+  // Removed elements are skipped, and a reused slot counts as changed
+  later = particles.advance_version<1>();
+  particles.update(5, 0.0, Vector2f(0, 0));
+  particles.remove(5);
+  assert(changed(particles, later).empty());
+  Entity reused = particles.insert(0.0, Vector2f(0, 0));
+  assert(reused == 5);
+  assert(changed(particles, later) == std::vector<Entity>{5});
+
+  // Dense storages report the changed entities, including the moved ones
+  seen = hardenings.advance_version<0>();
+  hardenings.update(100, 1.0);
+  hardenings.remove(0);
+  std::vector<Entity> dense = changed(hardenings, seen);
+  assert(dense.size() == 2);
+  assert(dense[0] == 998 && dense[1] == 100);
+  hardenings.for_each_changed<0>(seen, [](Entity i, const double &h) {
+    assert(h == (i == 100 ? 1.0 : 998.0));
+  });
+}
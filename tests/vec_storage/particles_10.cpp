@@ -0,0 +1,61 @@
+#include "storage_utils/Prelude.h"
+#include <algorithm>
+#include <assert.h>
+#include <vector>
+
+using Vector2f = std::tuple<float, float>;
+
+// Mass, Position, Charge in pages of 16
+using Particles = VecStorageGroup<float, Vector2f, Paged<int, 16>>;
+
+int main() {
+  Particles particles;
+  for (int i = 0; i < 100; i++) {
+    particles.insert(i, Vector2f(i, -i), i);
+  }
+
+  // A packed storage is extracted as a whole
+  std::vector<float> masses = particles.extract<0>();
+  assert(masses.size() == 100);
+  for (int i = 0; i < 100; i++) {
+    assert(masses[i] == i);
+  }
+
+  // Removed slots are skipped, and paged columns are copied page by page
+  for (Entity i : {0, 15, 16, 17, 50, 99}) {
+    particles.remove(i);
+  }
+  std::vector<int> charges = particles.extract<2>();
+  assert(charges.size() == 94);
+  std::vector<int> expected;
+  for (auto [i, m, x, c] : particles) {
+    expected.push_back(c);
+  }
+  assert(charges == expected);
+
+  // Several components in one pass
+  auto [ms, xs, cs] = particles.extract<0, 1, 2>();
+  assert(ms.size() == 94 && xs.size() == 94 && cs == expected);
+  for (std::size_t k = 0; k < ms.size(); k++) {
+    assert(std::get<0>(xs[k]) == ms[k] && std::get<1>(xs[k]) == -ms[k]);
+    assert(cs[k] == ms[k]);
+  }
+
+  // Into a caller-owned buffer
+  std::vector<Vector2f> buffer(particles.size());
+  assert(particles.extract_into<1>(buffer) == 94);
+  assert(buffer == xs);
+
+  // A short buffer only gets the first elements, and nothing past its end
+  std::vector<int> short_buffer(40, -1);
+  assert(particles.extract_into<2>(Span<int>(short_buffer.data(), 30)) == 30);
+  assert(std::equal(short_buffer.begin(), short_buffer.begin() + 30,
+                    expected.begin()));
+  assert(short_buffer[30] == -1 && short_buffer[39] == -1);
+  assert(particles.extract_into<0>(Span<float>()) == 0);
+
+  // An empty storage
+  Particles empty;
+  assert(empty.extract<0>().empty());
+  assert(std::get<1>(empty.extract<0, 2>()).empty());
+}
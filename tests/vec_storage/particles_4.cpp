@@ -1,5 +1,6 @@
 #include "storage_utils/Prelude.h"
 #include <assert.h>
+#include <cmath>
 #include <fstream>
 #include <iostream>
 
@@ -32,14 +33,14 @@ Vector2f random_direction() {
 }
 
 void step(Particles &particles) {
-  // Remove all the particles that are outside, and count the number
-  unsigned int removed_count = 0;
+  // Record the replacement of all the particles that are outside
+  auto commands = particles.commands();
   for (auto [index, position, _] : particles) {
     bool out_x = std::get<0>(position) < 0.0 || std::get<0>(position) > 1.0;
     bool out_y = std::get<1>(position) < 0.0 || std::get<1>(position) > 1.0;
     if (out_x || out_y) {
-      particles.remove(index);
-      removed_count += 1;
+      commands.remove(index);
+      commands.insert(random_point_on_side(), random_direction());
     }
   }
 
@@ -49,10 +50,11 @@ void step(Particles &particles) {
     std::get<1>(position) += std::get<1>(velocity);
   }
 
-  // Add particles
-  for (int i = 0; i < removed_count; i++) {
-    particles.insert(random_point_on_side(), random_direction());
-  }
+  // Replace the outside particles, so that the new ones move from the next
+  // step on
+  std::size_t size = particles.size();
+  commands.apply();
+  assert(particles.size() == size);
 }
 
 void dump(Particles &particles, const std::string &filename) {
@@ -0,0 +1,54 @@
+#include "storage_utils/Prelude.h"
+#include <assert.h>
+
+// Mass, Charge
+typedef VecStorageGroup<float, int> Particles;
+
+int main() {
+  Particles particles;
+
+  // Insert 1000 particles, spanning multiple 64-bit liveness words
+  for (int i = 0; i < 1000; i++) {
+    particles.insert(i, i);
+  }
+
+  // Remove a long dead run crossing several words, plus every third particle
+  for (int i = 10; i < 300; i++) {
+    assert(particles.remove(i));
+  }
+  for (int i = 300; i < 1000; i += 3) {
+    assert(particles.remove(i));
+  }
+  assert(particles.size() == 10 + 700 - 234);
+
+  // Iteration should skip all the removed particles
+  std::size_t counter = 0;
+  for (auto [index, mass, charge] : particles) {
+    assert(index < 10 || (index >= 300 && index % 3 != 0));
+    assert(charge == index);
+    counter += 1;
+  }
+  assert(counter == particles.size());
+  assert(particles.extract<1>().size() == particles.size());
+
+  // Removing the particles in the front should move the iteration start
+  for (int i = 0; i < 10; i++) {
+    assert(particles.remove(i));
+  }
+  auto [first, first_mass, first_charge] = *particles.begin();
+  assert(first == 301);
+
+  // Removing everything while iterating should leave nothing to iterate
+  for (auto [index, mass, charge] : particles) {
+    assert(particles.remove(index));
+  }
+  assert(particles.is_empty());
+  assert(!(particles.begin() != particles.end()));
+
+  // Inserting again should reuse the removed slots
+  for (int i = 0; i < 1000; i++) {
+    particles.insert(i, i);
+  }
+  assert(particles.size() == 1000);
+  assert(particles._max_size() == 1000);
+}
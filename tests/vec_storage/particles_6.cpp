@@ -0,0 +1,56 @@
+#include "storage_utils/Prelude.h"
+#include <assert.h>
+
+// Remove particles 10, 30, 20 (in that order) from a storage of 40
+template <typename Particles>
+void insert_and_remove(Particles &particles) {
+  for (int i = 0; i < 40; i++) {
+    particles.insert(i, i);
+  }
+  assert(particles.remove(10));
+  assert(particles.remove(30));
+  assert(particles.remove(20));
+  assert(particles.size() == 37);
+}
+
+int main() {
+  // LIFO reuses the most recently removed slot first
+  VecStorageGroup<float, int> lifo;
+  insert_and_remove(lifo);
+  assert(lifo.insert(0.0, 0) == 20);
+  assert(lifo.insert(0.0, 0) == 30);
+  assert(lifo.insert(0.0, 0) == 10);
+  assert(lifo.insert(0.0, 0) == 40);
+  assert(lifo.size() == 41);
+
+  // Lowest-index-first keeps the storage packed at the front
+  BasicVecStorageGroup<LowestIndexFirstReuse, DefaultAlloc, float, int> lowest;
+  insert_and_remove(lowest);
+  assert(lowest.insert(0.0, 0) == 10);
+  assert(lowest.insert(0.0, 0) == 20);
+  assert(lowest.insert(0.0, 0) == 30);
+  assert(lowest.insert(0.0, 0) == 40);
+  assert(lowest.size() == 41);
+
+  // Removing the first element and reinserting should give it back
+  assert(lowest.remove(0));
+  assert(lowest.insert(0.0, 0) == 0);
+  auto [first, first_mass, first_charge] = *lowest.begin();
+  assert(first == 0);
+
+  // Append-only never fills the holes
+  BasicVecStorageGroup<AppendOnlyReuse, DefaultAlloc, float, int> append;
+  insert_and_remove(append);
+  assert(append.insert(0.0, 0) == 40);
+  assert(append.insert(0.0, 0) == 41);
+  assert(append.size() == 39);
+  assert(append._max_size() == 42);
+  assert(!append.contains(10));
+
+  std::size_t counter = 0;
+  for (auto [index, mass, charge] : append) {
+    assert(index != 10 && index != 20 && index != 30);
+    counter += 1;
+  }
+  assert(counter == 39);
+}
@@ -0,0 +1,43 @@
+#include "storage_utils/Prelude.h"
+#include <assert.h>
+
+// Mass, Position, Velocity
+typedef VecStorageGroup<float, float, float> Particles;
+
+int main() {
+  Particles particles;
+  for (int i = 0; i < 200; i++) {
+    particles.insert(1.0, i, 1.0);
+  }
+  for (int i = 0; i < 200; i += 2) {
+    particles.remove(i);
+  }
+
+  // The columns cover every slot, removed or not
+  auto x = particles.column<1>();
+  auto v = particles.column<2>();
+  assert(x.size() == 200 && v.size() == 200);
+
+  // A branch-free integration over the raw floats
+  for (std::size_t i = 0; i < x.size(); i++) {
+    x.data()[i] += v.data()[i];
+  }
+  for (auto [index, m, pos, vel] : particles) {
+    assert(pos == index + 1);
+  }
+
+  // The liveness mask tells the valid slots apart
+  auto alive = particles.liveness();
+  assert(alive.size() == 4);
+  std::size_t counter = 0;
+  for (std::size_t i = 0; i < x.size(); i++) {
+    bool valid = (alive[i / 64] >> (i % 64)) & 1;
+    assert(valid == particles.contains(i));
+    counter += valid;
+  }
+  assert(counter == particles.size());
+
+  // Writes through the span are visible through the storage
+  particles.column<0>()[1] = 5.0;
+  assert(particles.get_component<0>(1).value() == 5.0);
+}
@@ -0,0 +1,64 @@
+#include "storage_utils/Prelude.h"
+#include <assert.h>
+
+// Mass, Charge
+typedef VecStorageGroup<float, int> Particles;
+
+// Mass, Charge, in pages of 16
+typedef VecStorageGroup<float, Paged<int, 16>> PagedParticles;
+
+template <typename P>
+void check(P &particles) {
+  particles.reserve(1000);
+
+  std::vector<float> masses;
+  std::vector<int> charges;
+  for (int i = 0; i < 100; i++) {
+    masses.push_back(i);
+    charges.push_back(-i);
+  }
+
+  // Insert into an empty storage: everything is appended
+  EntityRange range_1 = particles.insert_many(masses, charges);
+  assert(range_1.reused.empty());
+  assert(range_1.appended_begin == 0 && range_1.appended_end == 100);
+  assert(particles.size() == 100);
+  for (auto [id, mass, charge] : particles) {
+    assert(mass == id && charge == -(int)id);
+  }
+
+  // Remove some, then insert again: the holes are filled first
+  for (int i = 10; i < 40; i++) {
+    particles.remove(i);
+  }
+  EntityRange range_2 = particles.insert_many(masses, charges);
+  assert(range_2.size() == 100);
+  assert(range_2.reused.size() == 30);
+  assert(range_2.appended_begin == 100 && range_2.appended_end == 170);
+  assert(particles.size() == 170);
+  assert(particles._max_size() == 170);
+  for (std::size_t k = 0; k < range_2.size(); k++) {
+    auto [mass, charge] = particles.get(range_2[k]).value();
+    assert(mass == k && charge == -(int)k);
+  }
+
+  // An empty batch changes nothing
+  std::vector<float> no_masses;
+  std::vector<int> no_charges;
+  assert(particles.insert_many(no_masses, no_charges).size() == 0);
+  assert(particles.size() == 170);
+
+  std::size_t counter = 0;
+  for (auto [id, mass, charge] : particles) {
+    counter += 1;
+  }
+  assert(counter == 170);
+}
+
+int main() {
+  Particles particles;
+  check(particles);
+
+  PagedParticles paged_particles;
+  check(paged_particles);
+}
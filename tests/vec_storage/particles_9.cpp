@@ -0,0 +1,77 @@
+#include "storage_utils/Prelude.h"
+#include <assert.h>
+#include <vector>
+
+// Mass, Charge
+using Particles = VecStorageGroup<float, int>;
+
+// Hardening
+using Hardenings = DenseStorageGroup<double>;
+
+int main() {
+  Particles particles;
+  Hardenings hardenings;
+  for (int i = 0; i < 200; i++) {
+    auto id = particles.insert(i, i % 3 - 1);
+    if (i % 2 == 0) {
+      hardenings.insert(id, i);
+    }
+  }
+
+  // Record the removal of every neutral particle, and one new particle for
+  // each of them, while iterating
+  auto commands = particles.commands(hardenings);
+  assert(commands.empty());
+  std::size_t neutral = 0, hardened = 0;
+  for (auto [i, m, c] : particles) {
+    if (c == 0) {
+      commands.remove(i);
+      commands.remove_from<0>(i);
+      commands.insert(-1.0, 1);
+      neutral++;
+      hardened += hardenings.contains(i);
+    }
+  }
+  assert(!commands.empty());
+
+  // Nothing is applied until `apply`
+  assert(particles.size() == 200 && hardenings.size() == 100);
+
+  // Invalid and duplicate removals are skipped
+  commands.remove(1);
+  commands.remove(1000);
+  std::vector<Entity> entities = commands.apply();
+  assert(commands.empty());
+  assert(entities.size() == neutral);
+  assert(particles.size() == 200);
+
+  // The new particles refill the removed slots, lowest first
+  for (std::size_t k = 0; k < entities.size(); k++) {
+    assert(entities[k] == 1 + 3 * k);
+    assert(particles.get_component<0>(entities[k]) == -1.0);
+  }
+  for (auto [i, m, c] : particles) {
+    assert(c != 0);
+  }
+  assert(hardenings.size() == 100 - hardened);
+
+  // Dense inserts follow the vec inserts in the same pass
+  commands.remove(0);
+  commands.insert(10.0, -1);
+  commands.insert_into<0>(1, 2.0);
+  commands.remove_from<0>(0);
+  entities = commands.apply();
+  assert(entities == std::vector<Entity>{0});
+  assert(!hardenings.contains(0) && hardenings.contains(1));
+  assert(particles.get_component<0>(0) == 10.0);
+
+  // A batch removal updates the first valid index once
+  std::vector<Entity> front;
+  for (Entity i = 0; i < 150; i++) {
+    front.push_back(i);
+  }
+  assert(particles.remove_many(front) == 150);
+  assert(particles.size() == 50);
+  assert(std::get<0>(*particles.begin()) == 150);
+  assert(particles.insert(0.0, 0) == 0);
+}
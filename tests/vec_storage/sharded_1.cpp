@@ -0,0 +1,102 @@
+#include "storage_utils/Prelude.h"
+#include <assert.h>
+#include <vector>
+
+// Shard, Mass in shards of 1024 particles
+using Particles = ShardedVecStorageGroup<int, float>;
+
+// Hardening
+using Hardenings = DenseStorageGroup<float>;
+
+int main() {
+  ThreadPool pool(4);
+  Particles particles(4, 10);
+  assert(particles.num_shards() == 4 && particles.shard_capacity() == 1024);
+
+  // Every worker inserts, removes and reinserts in its own shard
+  pool.run(4, [&](std::size_t shard) {
+    std::vector<Entity> ids;
+    for (int k = 0; k < 1000; k++) {
+      auto id = particles.insert(shard, int(shard), k);
+      assert(id && particles.shard_of(*id) == shard);
+      ids.push_back(*id);
+    }
+    for (int k = 0; k < 1000; k += 3) {
+      assert(particles.remove(ids[k]));
+    }
+    for (int k = 0; k < 100; k++) {
+      particles.insert(shard, int(shard), -1);
+    }
+  });
+  assert(particles.size() == 4 * 766);
+  assert(particles._max_size() == 3 * 1024 + 1000);
+  assert(particles.contains(1024 + 1) && !particles.contains(1000));
+  assert(particles.get_component_unchecked<0>(2048 + 5) == 2);
+  assert(!particles.get(5000) && !particles.remove(5000));
+
+  // Iteration presents one storage, in entity order
+  std::size_t count = 0;
+  Entity last = 0;
+  for (auto [i, shard, m] : particles) {
+    assert(shard == int(particles.shard_of(i)) && (count == 0 || i > last));
+    assert(m == -1 || m == float(i % 1024));
+    last = i;
+    count++;
+  }
+  assert(count == particles.size());
+
+  // A full shard refuses inserts
+  std::size_t inserted = 0;
+  while (particles.insert(1, 1, 0.0)) {
+    inserted++;
+  }
+  assert(inserted == 1024 - 766);
+  auto id = particles.insert(2, 2, 0.0);
+  assert(id && particles.shard_of(*id) == 2);
+
+  // There's no shard past the last one
+  assert(!particles.insert(4, 4, 0.0) && !particles.emplace(100, 4, 0.0));
+
+  // Joins probe the dense storages with the global entities
+  Hardenings hardenings;
+  for (Entity i = particles.find_next(0); i < particles._max_size();
+       i = particles.find_next(i + 1)) {
+    if (i % 2 == 0) {
+      hardenings.insert(i, 0.5);
+    }
+  }
+  count = 0;
+  for (auto [i, shard, m, h] : particles.join(hardenings)) {
+    assert(i % 2 == 0 && h == 0.5 && shard == int(i / 1024));
+    count++;
+  }
+  assert(count == hardenings.size());
+  count = 0;
+  for (auto [i, shard] : particles.join(hardenings).view<0>()) {
+    count++;
+  }
+  assert(count == hardenings.size());
+
+  // Chunks never cross a shard
+  count = 0;
+  particles.for_each_chunk([&](Entity begin, Entity end, int *shard, float *) {
+    assert(begin / 1024 == (end - 1) / 1024);
+    for (std::size_t k = 0; k < end - begin; k++) {
+      assert(shard[k] == int(begin / 1024));
+    }
+    count += end - begin;
+  });
+  assert(count == particles.size());
+
+  // Every element is visited once by the workers of the shards
+  particles.par_for_each(pool, [](Entity i, int &shard, float &m) {
+    assert(shard == int(i / 1024));
+    m = 1.0;
+  });
+  for (auto [i, m] : particles.view<1>()) {
+    assert(m == 1.0);
+  }
+
+  StorageStats stats = particles.stats();
+  assert(stats.size == particles.size() && stats.columns.size() == 2);
+}